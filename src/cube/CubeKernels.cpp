@@ -0,0 +1,237 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#include "CubeKernels.h"
+#include "FastRubiksCube.h"
+#include "PermutationRanking.h"
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+
+#ifdef RUBIK_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+#endif
+
+//The SIMD composition loads corners + orientations as one 16 byte vector and the edge arrays with overlapping loads
+static_assert(offsetof(FastRubiksCube, corners) == 0, "FastRubiksCube layout changed");
+static_assert(offsetof(FastRubiksCube, cornerOrientations) == 8, "FastRubiksCube layout changed");
+static_assert(offsetof(FastRubiksCube, edges) == 16, "FastRubiksCube layout changed");
+static_assert(offsetof(FastRubiksCube, edgeOrientations) == 28, "FastRubiksCube layout changed");
+static_assert(sizeof(FastRubiksCube) == 40, "FastRubiksCube layout changed");
+
+CubeKernels CUBE_KERNELS = {
+        KernelPath::SCALAR,
+        composeScalar,
+        lookupBatchScalar
+};
+
+void composeScalar(const FastRubiksCube& a, const FastRubiksCube& b, FastRubiksCube& out) {
+    FastRubiksCube result;
+
+    for (int i = 0; i < 8; i++) {
+        result.corners[i] = a.corners[b.corners[i]];
+        result.cornerOrientations[i] = (b.cornerOrientations[i] + a.cornerOrientations[b.corners[i]]) % 3;
+    }
+
+    for (int i = 0; i < 12; i++) {
+        result.edges[i] = a.edges[b.edges[i]];
+        result.edgeOrientations[i] = b.edgeOrientations[i] ^ a.edgeOrientations[b.edges[i]];
+    }
+
+    out = result;
+}
+
+void lookupBatchScalar(const uint8_t* table, [[maybe_unused]] uint64_t tableSize, const uint32_t* indices, uint8_t* out, int count) {
+    for (int i = 0; i < count; i++) {
+        out[i] = table[indices[i]];
+    }
+}
+
+#ifdef RUBIK_X86
+/*
+ * Composition is a byte shuffle: a.corners[b.corners[i]] is pshufb(a.corners, b.corners), and shifting the indices by 8
+ * gathers the orientations in the same instruction. Orientations are added and reduced mod 3 with min(x, x - 3).
+ * Edges are 12 + 12 bytes so they're read as [edges, eo 0..3] and [edges 8..11, eo] and written back the same way.
+ */
+RUBIK_TARGET("ssse3,sse4.1")
+static void composeSSE4(const FastRubiksCube& a, const FastRubiksCube& b, FastRubiksCube& out) {
+    const uint8_t* aBytes = a.corners;
+    const uint8_t* bBytes = b.corners;
+
+    __m128i aCorners = _mm_loadu_si128((const __m128i*) aBytes);
+    __m128i bCorners = _mm_loadu_si128((const __m128i*) bBytes);
+
+    __m128i upperHalf = _mm_set_epi64x(-1, 0);
+    __m128i cornerIdx = _mm_add_epi8(_mm_unpacklo_epi64(bCorners, bCorners), _mm_and_si128(_mm_set1_epi8(8), upperHalf));
+    __m128i corners = _mm_shuffle_epi8(aCorners, cornerIdx);
+    corners = _mm_add_epi8(corners, _mm_and_si128(bCorners, upperHalf));
+    corners = _mm_min_epu8(corners, _mm_sub_epi8(corners, _mm_and_si128(_mm_set1_epi8(3), upperHalf)));
+
+    __m128i aEdges = _mm_loadu_si128((const __m128i*) (aBytes + 16));
+    __m128i aEdgeOrientations = _mm_loadu_si128((const __m128i*) (aBytes + 24));
+    __m128i bEdges = _mm_loadu_si128((const __m128i*) (bBytes + 16));
+    __m128i bEdgeOrientations = _mm_srli_si128(_mm_loadu_si128((const __m128i*) (bBytes + 24)), 4);
+
+    //Lanes 12..15 hold orientations, setting their top bit makes pshufb write zeroes there
+    __m128i edgeIdx = _mm_or_si128(bEdges, _mm_set_epi32((int) 0x80808080, 0, 0, 0));
+    __m128i edges = _mm_shuffle_epi8(aEdges, edgeIdx);
+    __m128i edgeOrientations = _mm_shuffle_epi8(aEdgeOrientations, _mm_add_epi8(edgeIdx, _mm_set1_epi8(4)));
+    edgeOrientations = _mm_xor_si128(edgeOrientations, bEdgeOrientations);
+
+    __m128i low = _mm_or_si128(edges, _mm_slli_si128(edgeOrientations, 12));
+    __m128i high = _mm_or_si128(_mm_srli_si128(edges, 8), _mm_slli_si128(edgeOrientations, 4));
+
+    uint8_t* outBytes = out.corners;
+    _mm_storeu_si128((__m128i*) outBytes, corners);
+    _mm_storeu_si128((__m128i*) (outBytes + 16), low);
+    _mm_storeu_si128((__m128i*) (outBytes + 24), high);
+}
+
+//Pruning lookups are cache misses, issuing all the prefetches first lets them overlap instead of happening one by one
+RUBIK_TARGET("sse4.1")
+static void lookupBatchSSE4(const uint8_t* table, [[maybe_unused]] uint64_t tableSize, const uint32_t* indices, uint8_t* out, int count) {
+    for (int i = 0; i < count; i++) {
+        _mm_prefetch((const char*) (table + indices[i]), _MM_HINT_T0);
+    }
+
+    for (int i = 0; i < count; i++) {
+        out[i] = table[indices[i]];
+    }
+}
+
+//Gathers read 4 bytes per lane, so lanes that would read past the end of the table are masked out and done by hand
+RUBIK_TARGET("avx2")
+static void lookupBatchAVX2(const uint8_t* table, uint64_t tableSize, const uint32_t* indices, uint8_t* out, int count) {
+    if (tableSize > 0x7FFFFFFF) {
+        lookupBatchSSE4(table, tableSize, indices, out, count);
+        return;
+    }
+
+    __m256i lastSafe = _mm256_set1_epi32((int) (tableSize - 4));
+    alignas(32) uint32_t gathered[8];
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i idx = _mm256_loadu_si256((const __m256i*) (indices + i));
+        __m256i safe = _mm256_xor_si256(_mm256_cmpgt_epi32(idx, lastSafe), _mm256_set1_epi32(-1));
+        __m256i values = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), (const int*) table, idx, safe, 1);
+        _mm256_store_si256((__m256i*) gathered, values);
+
+        int unsafeLanes = ~_mm256_movemask_ps(_mm256_castsi256_ps(safe)) & 0xFF;
+        for (int j = 0; j < 8; j++) {
+            out[i + j] = (unsafeLanes >> j) & 1 ? table[indices[i + j]] : (uint8_t) gathered[j];
+        }
+    }
+
+    for (; i < count; i++) {
+        out[i] = table[indices[i]];
+    }
+}
+
+
+
+#endif
+
+const char* getKernelPathName(KernelPath path) {
+    switch (path) {
+        case KernelPath::SCALAR:
+            return "scalar";
+        case KernelPath::SSE4:
+            return "SSE4";
+        case KernelPath::AVX2:
+            return "AVX2";
+        case KernelPath::AVX512:
+            return "AVX-512";
+    }
+
+    return "unknown";
+}
+
+static KernelPath detectKernelPath() {
+    KernelPath path = KernelPath::SCALAR;
+
+#ifdef RUBIK_X86
+    const CpuFeatures& features = getCpuFeatures();
+
+    if (features.ssse3 && features.sse41 && features.popcnt) {
+        path = KernelPath::SSE4;
+
+        if (features.avx2) {
+            path = KernelPath::AVX2;
+
+            if (features.avx512) {
+                path = KernelPath::AVX512;
+            }
+        }
+    }
+#endif
+
+    const char* cap = std::getenv("RUBIK_KERNELS");
+    if (cap) {
+        std::string capName = cap;
+        KernelPath capPath = path;
+
+        if (capName == "scalar") capPath = KernelPath::SCALAR;
+        else if (capName == "sse4") capPath = KernelPath::SSE4;
+        else if (capName == "avx2") capPath = KernelPath::AVX2;
+        else if (capName == "avx512") capPath = KernelPath::AVX512;
+        else std::cerr << "Unknown RUBIK_KERNELS value " << capName << ", ignoring it" << std::endl;
+
+        if (capPath < path) {
+            path = capPath;
+        }
+    }
+
+    return path;
+}
+
+void initCubeKernels() {
+    KernelPath path = detectKernelPath();
+    CUBE_KERNELS.path = path;
+
+#ifdef RUBIK_X86
+    if (path >= KernelPath::SSE4) {
+        CUBE_KERNELS.compose = composeSSE4;
+        CUBE_KERNELS.lookupBatch = lookupBatchSSE4;
+    }
+
+    if (path >= KernelPath::AVX2) {
+        CUBE_KERNELS.lookupBatch = lookupBatchAVX2;
+    }
+#endif
+
+    //Ranking only depends on popcnt/bmi2, but a capped path should cap it too
+    if (path == KernelPath::SCALAR) {
+        rankPermutation = rankPermutationTable;
+        unrankPermutation = unrankPermutationScalar;
+    } else {
+        initPermutationRanking();
+    }
+
+    std::cout << "Cube kernels: " << describeCubeKernels() << std::endl;
+}
+
+std::string describeCubeKernels() {
+    std::string cpu;
+
+#ifdef RUBIK_X86
+    const CpuFeatures& features = getCpuFeatures();
+    if (features.popcnt) cpu += " popcnt";
+    if (features.bmi2) cpu += features.fastPdep ? " bmi2" : " bmi2(slow pdep)";
+    if (features.ssse3) cpu += " ssse3";
+    if (features.sse41) cpu += " sse4.1";
+    if (features.avx2) cpu += " avx2";
+    if (features.avx512) cpu += " avx512";
+#endif
+
+    if (cpu.empty()) {
+        cpu = " none";
+    }
+
+    return std::string(getKernelPathName(CUBE_KERNELS.path)) + " (ranking: " + getPermutationRankingName() + ", cpu:" + cpu + ")";
+}
@@ -0,0 +1,51 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_CUBEKERNELS_H
+#define RUBIK_CUBEKERNELS_H
+
+#include <stdint.h>
+#include <string>
+#include "util/CpuFeatures.h"
+
+class FastRubiksCube;
+
+/*
+ * The build targets baseline x86-64, so anything wider is picked at runtime instead. initCubeKernels looks at CPUID
+ * once, chooses the best path the CPU supports and points every kernel at the best implementation available for that
+ * path (not every kernel has a version for every path, e.g. composition tops out at SSE4).
+ *
+ * Setting RUBIK_KERNELS to scalar/sse4/avx2/avx512 caps the path, which is handy for comparing implementations.
+ */
+
+enum class KernelPath {
+    SCALAR,
+    SSE4,
+    AVX2,
+    AVX512
+};
+
+struct CubeKernels {
+    KernelPath path;
+
+    //out = a * b, the same thing as a.copyAndApplyTo(b). out may alias either input.
+    void (*compose)(const FastRubiksCube& a, const FastRubiksCube& b, FastRubiksCube& out);
+
+    //out[i] = table[indices[i]], all indices have to be smaller than tableSize
+    void (*lookupBatch)(const uint8_t* table, uint64_t tableSize, const uint32_t* indices, uint8_t* out, int count);
+};
+
+//Starts out pointing at the scalar kernels so everything works before initCubeKernels is called
+extern CubeKernels CUBE_KERNELS;
+
+void initCubeKernels();
+
+const char* getKernelPathName(KernelPath path);
+//Chosen path plus the CPU features it was based on, for logs and the stats panel
+std::string describeCubeKernels();
+
+void composeScalar(const FastRubiksCube& a, const FastRubiksCube& b, FastRubiksCube& out);
+void lookupBatchScalar(const uint8_t* table, uint64_t tableSize, const uint32_t* indices, uint8_t* out, int count);
+
+#endif //RUBIK_CUBEKERNELS_H
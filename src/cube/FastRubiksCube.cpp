@@ -126,6 +126,8 @@ void initFastRubiksCubeData() {
         BIT_COUNT_U16[i] = count;
     }
 
+    initCubeKernels();
+
     //testMoves();
 
     std::cout << "FastRubiksCube initialized" <<std::endl;
@@ -133,9 +135,6 @@ void initFastRubiksCubeData() {
     initSolver();
 }
 
-constexpr FastRubiksCube::FastRubiksCube()
-{}
-
 FastRubiksCube::FastRubiksCube(const RubiksCube &cube) {
     for (int i = 0; i < 8; i++) {
         CornerData cd = cube.getCorner((Corner) i);
@@ -174,21 +173,10 @@ FastRubiksCube::FastRubiksCube(const RubiksCube &cube) {
 
 //this.corners[x] stores the position of edge x
 //this.cornerOrientation[x] stores the orientation of the corner at position x
+//See composeScalar in CubeKernels.cpp for the plain version
 FastRubiksCube FastRubiksCube::copyAndApplyTo(const FastRubiksCube& cube) const {
-    FastRubiksCube result = cube;
-
-    for (int i = 0; i < 8; i++) {
-        result.corners[i] = this->corners[cube.corners[i]];
-        result.cornerOrientations[i] =
-                (cube.cornerOrientations[i] + this->cornerOrientations[cube.corners[i]]) % 3;
-    }
-
-    for (int i = 0; i < 12; i++) {
-        result.edges[i] = this->edges[cube.edges[i]];
-        result.edgeOrientations[i] =
-                (cube.edgeOrientations[i] ^ this->edgeOrientations[cube.edges[i]]);
-    }
-
+    FastRubiksCube result;
+    CUBE_KERNELS.compose(*this, cube, result);
     return result;
 }
 
@@ -237,17 +225,7 @@ RubiksCube FastRubiksCube::toRubiksCube() const {
 }
 
 uint32_t FastRubiksCube::getCornerPermutationIndex() const {
-    uint32_t seen = 0;
-    uint32_t result = 0;
-
-    for (int i = 0; i < 8; i++) {
-        int v = corners[i];
-        int count = BIT_COUNT_U16[seen >> (8 - v)];
-        result += (v - count) * FACTORIAL_U32[7 - i];
-        seen |= (1 << (7 - v));
-    }
-
-    return result;
+    return rankPermutation(corners, 8, 8);
 }
 
 uint32_t FastRubiksCube::getCornerOrientationIndex() const {
@@ -264,18 +242,30 @@ uint32_t FastRubiksCube::getCornerIndex() const {
     return getCornerPermutationIndex() * 2187 + getCornerOrientationIndex();
 }
 
-uint32_t FastRubiksCube::getEdgePermutationIndex() const {
-    uint32_t seen = 0;
-    uint32_t result = 0;
+FastRubiksCube FastRubiksCube::fromCornerIndex(uint32_t index) {
+    FastRubiksCube cube;
+    unrankPermutation(index / 2187, cube.corners, 8, 8);
 
-    for (int i = 0; i < 12; i++) {
-        int v = edges[i];
-        int count = BIT_COUNT_U16[seen >> (12 - v)];
-        result += (v - count) * FACTORIAL_U32[11 - i];
-        seen |= (1 << (11 - v));
+    uint32_t orientation = index % 2187;
+    int sum = 0;
+    for (int i = 6; i >= 0; i--) {
+        cube.cornerOrientations[i] = orientation % 3;
+        sum += cube.cornerOrientations[i];
+        orientation /= 3;
     }
+    cube.cornerOrientations[7] = (3 - sum % 3) % 3;
 
-    return result;
+    return cube;
+}
+
+FastRubiksCube FastRubiksCube::fromEdgePermutationIndex(uint32_t index) {
+    FastRubiksCube cube;
+    unrankPermutation(index, cube.edges, 12, 12);
+    return cube;
+}
+
+uint32_t FastRubiksCube::getEdgePermutationIndex() const {
+    return rankPermutation(edges, 12, 12);
 }
 
 uint32_t FastRubiksCube::getEdgeOrientationIndex() const {
@@ -339,17 +329,12 @@ bool FastRubiksCube::isSolved() const {
 
 
 uint32_t FastRubiksCube::getPartialEdgePermutationIndex(std::vector<Edge>& edgeGroup) const {
-    uint32_t seen = 0;
-    uint32_t result = 0;
-
+    uint8_t values[12];
     for (int i = 0; i < edgeGroup.size(); i++) {
-        int v = edges[edgeGroup[i]];
-        int count = BIT_COUNT_U16[seen >> (12 - v)];
-        result += (v - count) * NPR_U32[11 - i][edgeGroup.size() - i - 1];
-        seen |= (1 << (11 - v));
+        values[i] = edges[edgeGroup[i]];
     }
 
-    return result;
+    return rankPermutation(values, edgeGroup.size(), 12);
 }
 
 uint32_t FastRubiksCube::getPartialEdgeOrientationIndex(std::vector<Edge>& edgeGroup) const {
@@ -366,17 +351,12 @@ uint64_t FastRubiksCube::getPartialEdgeIndex(std::vector<Edge>& edgeGroup) const
 }
 
 uint32_t FastRubiksCube::getPartialCornerPermutationIndex(std::vector<Corner>& cornerGroup) const {
-    uint32_t seen = 0;
-    uint32_t result = 0;
-
+    uint8_t values[8];
     for (int i = 0; i < cornerGroup.size(); i++) {
-        int v = corners[cornerGroup[i]];
-        int count = BIT_COUNT_U16[seen >> (8 - v)];
-        result += (v - count) * NPR_U32[7 - i][cornerGroup.size() - i - 1];
-        seen |= (1 << (7 - v));
+        values[i] = corners[cornerGroup[i]];
     }
 
-    return result;
+    return rankPermutation(values, cornerGroup.size(), 8);
 }
 
 uint32_t FastRubiksCube::getPartialCornerOrientationIndex(std::vector<Corner>& cornerGroup) const {
@@ -7,6 +7,8 @@
 
 
 #include "RubiksCube.h"
+#include "PermutationRanking.h"
+#include "CubeKernels.h"
 #include <array>
 #include <vector>
 
@@ -31,7 +33,7 @@ public:
     uint8_t edges[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
     uint8_t edgeOrientations[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 
-    constexpr FastRubiksCube();
+    constexpr FastRubiksCube() {}
     explicit FastRubiksCube(const RubiksCube& cube);
 
     [[nodiscard]] FastRubiksCube copyAndApplyTo(const FastRubiksCube& cube) const;
@@ -47,17 +49,12 @@ public:
 
     template<size_t Size>
     [[nodiscard]] uint32_t getPartialEdgePermutationIndex(std::array<Edge, Size>& edgeGroup) const {
-        uint32_t seen = 0;
-        uint32_t result = 0;
-
+        uint8_t values[Size];
         for (int i = 0; i < Size; i++) {
-            int v = edges[edgeGroup[i]];
-            int count = BIT_COUNT_U16[seen >> (12 - v)];
-            result += (v - count) * NPR_U32[11 - i][Size - i - 1];
-            seen |= (1 << (11 - v));
+            values[i] = edges[edgeGroup[i]];
         }
 
-        return result;
+        return rankPermutation(values, Size, 12);
     }
 
     template<size_t Size>
@@ -75,6 +72,35 @@ public:
         return ((uint64_t) getPartialEdgePermutationIndex(edgeGroup)) * (1 << Size) + getPartialEdgeOrientationIndex(edgeGroup);
     }
 
+    //Inverse of getPartialEdgeIndex. Edges outside of the group get whatever positions are left over, which is fine for
+    //anything that only looks at the group (moves never mix up the entries of different edges)
+    template<size_t Size>
+    [[nodiscard]] static FastRubiksCube fromPartialEdgeIndex(std::array<Edge, Size>& edgeGroup, uint64_t index) {
+        FastRubiksCube cube;
+
+        uint8_t values[Size];
+        unrankPermutation((uint32_t) (index >> Size), values, Size, 12);
+
+        bool used[12] = {false};
+        bool inGroup[12] = {false};
+        for (int i = 0; i < Size; i++) {
+            cube.edges[edgeGroup[i]] = values[i];
+            cube.edgeOrientations[edgeGroup[i]] = (index >> (Size - 1 - i)) & 1;
+            used[values[i]] = true;
+            inGroup[edgeGroup[i]] = true;
+        }
+
+        int next = 0;
+        for (int i = 0; i < 12; i++) {
+            if (inGroup[i]) continue;
+            while (used[next]) next++;
+            cube.edges[i] = next++;
+            cube.edgeOrientations[i] = 0;
+        }
+
+        return cube;
+    }
+
     [[nodiscard]] uint32_t getPartialEdgePermutationIndex(std::vector<Edge>& edgeGroup) const;
     [[nodiscard]] uint32_t getPartialEdgeOrientationIndex(std::vector<Edge>& edgeGroup) const;
     [[nodiscard]] uint64_t getPartialEdgeIndex(std::vector<Edge>& edgeGroup) const;
@@ -83,19 +109,18 @@ public:
     [[nodiscard]] uint32_t getCornerOrientationIndex() const;
     [[nodiscard]] uint32_t getCornerIndex() const;
 
+    //Inverses of getCornerIndex and getEdgePermutationIndex, everything the index doesn't cover is left solved
+    [[nodiscard]] static FastRubiksCube fromCornerIndex(uint32_t index);
+    [[nodiscard]] static FastRubiksCube fromEdgePermutationIndex(uint32_t index);
+
     template<size_t Size>
     [[nodiscard]] uint32_t getPartialCornerPermutationIndex(std::array<Corner, Size>& cornerGroup) const {
-        uint32_t seen = 0;
-        uint32_t result = 0;
-
+        uint8_t values[Size];
         for (int i = 0; i < Size; i++) {
-            int v = corners[cornerGroup[i]];
-            int count = BIT_COUNT_U16[seen >> (8 - v)];
-            result += (v - count) * NPR_U32[7 - i][Size - i - 1];
-            seen |= (1 << (7 - v));
+            values[i] = corners[cornerGroup[i]];
         }
 
-        return result;
+        return rankPermutation(values, Size, 8);
     }
 
     template<size_t Size>
@@ -183,7 +208,7 @@ public:
     [[nodiscard]] bool isPartiallySolved(std::vector<Edge>& edgeGroup) const;
     [[nodiscard]] bool isPartiallySolved(std::vector<Corner>& cornerGroup) const;
 
-    inline bool operator==(const FastRubiksCube& other) const {
+    constexpr bool operator==(const FastRubiksCube& other) const {
         for (int i = 0; i < 8; i++) {
             if (corners[i] != other.corners[i] || cornerOrientations[i] != other.cornerOrientations[i]) {
                 return false;
@@ -197,7 +222,7 @@ public:
         return true;
     }
 
-    inline bool operator!=(const FastRubiksCube& other) const {
+    constexpr bool operator!=(const FastRubiksCube& other) const {
         for (int i = 0; i < 8; i++) {
             if (corners[i] != other.corners[i] || cornerOrientations[i] != other.cornerOrientations[i]) {
                 return true;
@@ -0,0 +1,113 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#include "PermutationRanking.h"
+#include "FastRubiksCube.h"
+
+#ifdef RUBIK_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+#endif
+
+RankPermutationFunc rankPermutation = rankPermutationTable;
+UnrankPermutationFunc unrankPermutation = unrankPermutationScalar;
+
+uint32_t rankPermutationTable(const uint8_t* values, int k, int n) {
+    uint32_t seen = 0;
+    uint32_t result = 0;
+
+    for (int i = 0; i < k; i++) {
+        int v = values[i];
+        int count = BIT_COUNT_U16[seen >> (n - v)];
+        result += (v - count) * NPR_U32[n - 1 - i][k - 1 - i];
+        seen |= (1 << (n - 1 - v));
+    }
+
+    return result;
+}
+
+void unrankPermutationScalar(uint32_t rank, uint8_t* out, int k, int n) {
+    uint32_t used = 0;
+
+    for (int i = 0; i < k; i++) {
+        uint32_t weight = NPR_U32[n - 1 - i][k - 1 - i];
+        int digit = rank / weight;
+        rank %= weight;
+
+        int v = 0;
+        while (true) {
+            if (!(used & (1 << v))) {
+                if (digit == 0) break;
+                digit--;
+            }
+            v++;
+        }
+
+        out[i] = v;
+        used |= (1 << v);
+    }
+}
+
+#ifdef RUBIK_X86
+//Bit v of seen is set once value v has been used, so the used values below v are exactly seen & ((1 << v) - 1)
+RUBIK_TARGET("popcnt")
+uint32_t rankPermutationPopcnt(const uint8_t* values, int k, int n) {
+    uint32_t seen = 0;
+    uint32_t result = 0;
+
+    for (int i = 0; i < k; i++) {
+        uint32_t v = values[i];
+        uint32_t below = (1u << v) - 1;
+#ifdef _MSC_VER
+        uint32_t count = __popcnt(seen & below);
+#else
+        uint32_t count = __builtin_popcount(seen & below);
+#endif
+        result += (v - count) * NPR_U32[n - 1 - i][k - 1 - i];
+        seen |= (1u << v);
+    }
+
+    return result;
+}
+
+//pdep deposits a single bit into the digit-th set bit of the available mask, tzcnt turns that back into the value
+RUBIK_TARGET("bmi,bmi2")
+void unrankPermutationBMI2(uint32_t rank, uint8_t* out, int k, int n) {
+    uint32_t available = (1u << n) - 1;
+
+    for (int i = 0; i < k; i++) {
+        uint32_t weight = NPR_U32[n - 1 - i][k - 1 - i];
+        uint32_t digit = rank / weight;
+        rank %= weight;
+
+        uint32_t bit = _pdep_u32(1u << digit, available);
+        out[i] = (uint8_t) _tzcnt_u32(bit);
+        available &= ~bit;
+    }
+}
+#endif
+
+static const char* rankingName = "table";
+
+void initPermutationRanking() {
+#ifdef RUBIK_X86
+    const CpuFeatures& features = getCpuFeatures();
+
+    if (features.popcnt) {
+        rankPermutation = rankPermutationPopcnt;
+        rankingName = features.fastPdep ? "popcnt + pdep" : "popcnt";
+    }
+
+    if (features.fastPdep) {
+        unrankPermutation = unrankPermutationBMI2;
+    }
+#endif
+}
+
+const char* getPermutationRankingName() {
+    return rankingName;
+}
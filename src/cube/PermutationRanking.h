@@ -0,0 +1,54 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_PERMUTATIONRANKING_H
+#define RUBIK_PERMUTATIONRANKING_H
+
+#include <stdint.h>
+#include "util/CpuFeatures.h"
+
+/*
+ * All the permutation coordinates (full and partial, corners and edges) are the same thing: k distinct values picked
+ * out of 0..n-1, ranked as a Lehmer code where digit i is "how many unused values are smaller than values[i]" and has
+ * weight nPr(n - 1 - i, k - 1 - i).
+ *
+ * Counting the used values through BIT_COUNT_U16 means a lookup into a 64KB table that fights the pruning tables for
+ * cache. The popcnt kernel does it with a mask and a single instruction instead, and unranking uses pdep to jump
+ * straight to the d-th unused value. The table kernels are the fallback for CPUs without those instructions.
+ */
+
+typedef uint32_t (*RankPermutationFunc)(const uint8_t* values, int k, int n);
+typedef void (*UnrankPermutationFunc)(uint32_t rank, uint8_t* out, int k, int n);
+
+//Selected by initPermutationRanking, defaults to the table kernels so they are always safe to call
+extern RankPermutationFunc rankPermutation;
+extern UnrankPermutationFunc unrankPermutation;
+
+uint32_t rankPermutationTable(const uint8_t* values, int k, int n);
+void unrankPermutationScalar(uint32_t rank, uint8_t* out, int k, int n);
+
+#ifdef RUBIK_X86
+uint32_t rankPermutationPopcnt(const uint8_t* values, int k, int n);
+void unrankPermutationBMI2(uint32_t rank, uint8_t* out, int k, int n);
+#endif
+
+//0 for an even permutation, 1 for an odd one
+template<typename T>
+int permutationParity(const T* values, int n) {
+    int parity = 0;
+
+    for (int i = 0; i < n; i++) {
+        for (int j = i + 1; j < n; j++) {
+            if (values[i] > values[j]) parity ^= 1;
+        }
+    }
+
+    return parity;
+}
+
+//Needs NPR_U32 and BIT_COUNT_U16 to be filled in (see initFastRubiksCubeData). Called from initCubeKernels.
+void initPermutationRanking();
+const char* getPermutationRankingName();
+
+#endif //RUBIK_PERMUTATIONRANKING_H
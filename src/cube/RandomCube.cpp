@@ -0,0 +1,80 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#include "RandomCube.h"
+#include "PermutationRanking.h"
+#include "util/WorkStealing.h"
+
+#include <algorithm>
+
+static uint64_t mixSeed(uint64_t seed, uint64_t stream) {
+    std::seed_seq seq = {(uint32_t) seed, (uint32_t) (seed >> 32), (uint32_t) stream, (uint32_t) (stream >> 32)};
+
+    uint32_t out[2];
+    seq.generate(out, out + 2);
+
+    return ((uint64_t) out[1] << 32) | out[0];
+}
+
+RandomCubeGenerator::RandomCubeGenerator(uint64_t seed, uint64_t stream) : gen(mixSeed(seed, stream)) {
+
+}
+
+FastRubiksCube RandomCubeGenerator::next() {
+    //8! * 3^7 * 12! * 2^11 is far too big for one draw, so each coordinate gets its own
+    std::uniform_int_distribution<uint32_t> cornerPermDist(0, FACTORIAL_U32[8] - 1);
+    std::uniform_int_distribution<uint32_t> twistDist(0, 2186);
+    std::uniform_int_distribution<uint32_t> edgePermDist(0, FACTORIAL_U32[12] - 1);
+    std::uniform_int_distribution<uint32_t> flipDist(0, 2047);
+
+    FastRubiksCube cube;
+
+    unrankPermutation(cornerPermDist(gen), cube.corners, 8, 8);
+    unrankPermutation(edgePermDist(gen), cube.edges, 12, 12);
+
+    if (permutationParity(cube.corners, 8) != permutationParity(cube.edges, 12)) {
+        std::swap(cube.edges[10], cube.edges[11]);
+    }
+
+    uint32_t twist = twistDist(gen);
+    int twistSum = 0;
+    for (int i = 0; i < 7; i++) {
+        cube.cornerOrientations[i] = twist % 3;
+        twistSum += twist % 3;
+        twist /= 3;
+    }
+    cube.cornerOrientations[7] = (3 - twistSum % 3) % 3;
+
+    uint32_t flip = flipDist(gen);
+    int flipSum = 0;
+    for (int i = 0; i < 11; i++) {
+        cube.edgeOrientations[i] = flip & 1;
+        flipSum += flip & 1;
+        flip >>= 1;
+    }
+    cube.edgeOrientations[11] = flipSum % 2;
+
+    return cube;
+}
+
+void RandomCubeGenerator::fill(FastRubiksCube* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = next();
+    }
+}
+
+std::vector<FastRubiksCube> generateRandomCubes(size_t count, uint64_t seed, int numThreads) {
+    std::vector<FastRubiksCube> cubes(count);
+    size_t numStreams = (count + RANDOM_CUBES_PER_STREAM - 1) / RANDOM_CUBES_PER_STREAM;
+
+    runWorkStealing(numThreads, (int) numStreams, [&](int stream) {
+        size_t start = stream * RANDOM_CUBES_PER_STREAM;
+        size_t end = std::min(count, start + RANDOM_CUBES_PER_STREAM);
+
+        RandomCubeGenerator generator(seed, stream);
+        generator.fill(cubes.data() + start, end - start);
+    });
+
+    return cubes;
+}
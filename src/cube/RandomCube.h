@@ -0,0 +1,41 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_RANDOMCUBE_H
+#define RUBIK_RANDOMCUBE_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "FastRubiksCube.h"
+
+/*
+ * Uniformly random solvable cubes. Scrambling with random moves is slow and only approaches uniform as the scramble
+ * gets longer, so instead every coordinate (corner and edge permutation, twist and flip) is drawn uniformly and
+ * unranked straight into the cube. The last twist and flip follow from the others, and an odd edge permutation gets
+ * its last two edges swapped whenever the corner permutation is even (or the other way around), which pairs up the
+ * cubes one to one so the distribution stays uniform.
+ *
+ * A generator is not thread safe, but generators for different streams of the same seed are independent, so every
+ * thread can own one. Needs initFastRubiksCubeData to have run.
+ */
+
+class RandomCubeGenerator {
+public:
+    explicit RandomCubeGenerator(uint64_t seed, uint64_t stream = 0);
+
+    FastRubiksCube next();
+    void fill(FastRubiksCube* out, size_t count);
+
+private:
+    std::mt19937_64 gen;
+};
+
+//Cubes per stream in generateRandomCubes, so the output only depends on the seed and not on the number of threads
+const size_t RANDOM_CUBES_PER_STREAM = 4096;
+
+//count random cubes from seed, generated on numThreads threads (0 for one per core)
+std::vector<FastRubiksCube> generateRandomCubes(size_t count, uint64_t seed, int numThreads = 0);
+
+#endif //RUBIK_RANDOMCUBE_H
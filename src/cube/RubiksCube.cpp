@@ -3,7 +3,8 @@
 //
 
 #include "RubiksCube.h"
-#include "stb_image_write.h"
+#include "PermutationRanking.h"
+#include "util/CubeImage.h"
 #include <utility>
 
 RubiksCube::RubiksCube() {
@@ -429,64 +430,77 @@ void RubiksCube::flipEdge(Edge edge) {
     }
 }
 
-void RubiksCube::saveNetImage(const char *filename) {
-    //Each square is 50x50 pixels one pixel of which is a border
-    //So each face is 150x150 pixels
-    //Therefore the whole image is 600x450 pixels
+static bool sameCorner(const CornerData& a, const CornerData& b) {
+    return a.ud == b.ud && a.lr == b.lr && a.fb == b.fb;
+}
 
-    //Red Orange Blue Green Yellow White
-    const uint8_t COLORS_RGB[7][3] = {
-            {255, 0,   0}, //RED
-            {255, 165, 0}, //ORANGE
-            {0,   0,   255}, //BLUE
-            {0,   255, 0}, //GREEN
-            {255, 255, 0}, //YELLOW
-            {255, 255, 255}, //WHITE
-            {0,   0,   0} //BORDER
-    };
-
-    const int SQUARE_SIZE = 50;
-    const int FACE_SIZE = SQUARE_SIZE * 3;
-    const int IMAGE_WIDTH = FACE_SIZE * 4;
-    const int IMAGE_HEIGHT = FACE_SIZE * 3;
-
-    uint8_t* image = new uint8_t[IMAGE_WIDTH * IMAGE_HEIGHT * 3];
-
-    auto drawSquare = [&](int x, int y, FaceColor color) {
-        for (int i = 0; i < 50; i++) {
-            for (int j = 0; j < 50; j++) {
-                auto* c = COLORS_RGB[color];
-
-                if (i == 0 || i == 49 || j == 0 || j == 49) {
-                    c = COLORS_RGB[6];
-                }
+static bool sameEdge(const EdgeData& a, const EdgeData& b) {
+    return a.a == b.a && a.b == b.b;
+}
 
-                int xCoord = x * SQUARE_SIZE + i;
-                int yCoord = y * SQUARE_SIZE + j;
+bool RubiksCube::isSolvable() const {
+    int cornerAt[8];
+    bool cornerUsed[8] = {false};
+    int twist = 0;
 
-                image[(yCoord * IMAGE_WIDTH + xCoord) * 3] = c[0];
-                image[(yCoord * IMAGE_WIDTH + xCoord) * 3 + 1] = c[1];
-                image[(yCoord * IMAGE_WIDTH + xCoord) * 3 + 2] = c[2];
+    for (int pos = 0; pos < 8; pos++) {
+        CornerData actual = getCorner((Corner) pos);
+        cornerAt[pos] = -1;
+
+        //The stickers have to match one of the 24 ways a real corner can sit here
+        for (int corner = 0; corner < 8 && cornerAt[pos] == -1; corner++) {
+            for (int orientation = 0; orientation < 3; orientation++) {
+                RubiksCube candidate;
+                candidate.setCorner((Corner) pos, (Corner) corner, orientation);
+
+                if (sameCorner(candidate.getCorner((Corner) pos), actual)) {
+                    cornerAt[pos] = corner;
+                    break;
+                }
             }
         }
-    };
 
-    auto drawFace = [&](int x, int y, Side face) {
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 3; j++) {
-                drawSquare(x * 3 + j, y * 3 + i, (FaceColor) sides[face][i][j]);
+        if (cornerAt[pos] == -1 || cornerUsed[cornerAt[pos]]) return false;
+        cornerUsed[cornerAt[pos]] = true;
+
+        twist += getCornerOrientation((Corner) pos);
+    }
+
+    int edgeAt[12];
+    bool edgeUsed[12] = {false};
+    int flip = 0;
+
+    for (int pos = 0; pos < 12; pos++) {
+        EdgeData actual = getEdge((Edge) pos);
+        edgeAt[pos] = -1;
+
+        for (int edge = 0; edge < 12 && edgeAt[pos] == -1; edge++) {
+            for (int orientation = 0; orientation < 2; orientation++) {
+                RubiksCube candidate;
+                candidate.setEdge((Edge) pos, (Edge) edge, orientation);
+
+                if (sameEdge(candidate.getEdge((Edge) pos), actual)) {
+                    edgeAt[pos] = edge;
+                    break;
+                }
             }
         }
-    };
-
-    //Draw the faces
-    drawFace(1, 0, TOP);
-    drawFace(1, 2, BOTTOM);
-    drawFace(0, 1, LEFT);
-    drawFace(2, 1, RIGHT);
-    drawFace(1, 1, FRONT);
-    drawFace(3, 1, BACK);
-
-    //Save with stb_image_write
-    stbi_write_png(filename, IMAGE_WIDTH, IMAGE_HEIGHT, 3, image, IMAGE_WIDTH * 3);
+
+        if (edgeAt[pos] == -1 || edgeUsed[edgeAt[pos]]) return false;
+        edgeUsed[edgeAt[pos]] = true;
+
+        flip += getEdgeOrientation((Edge) pos);
+    }
+
+    return twist % 3 == 0 && flip % 2 == 0 && permutationParity(cornerAt, 8) == permutationParity(edgeAt, 12);
+}
+
+void RubiksCube::saveNetImage(const char *filename) {
+    //Each square is 50x50 pixels one pixel of which is a border
+    //So each face is 150x150 pixels
+    //Therefore the whole image is 600x450 pixels
+    Image image(600, 450, CUBE_IMAGE_COLORS[6]);
+    drawNet(image, *this, 0, 0, 50);
+
+    image.writePNG(filename);
 }
@@ -34,6 +34,10 @@ public:
     void setCorner(Corner targetPos, Corner targetValue, uint8_t orientation);
     void setEdge(Edge targetPos, Edge targetValue, uint8_t orientation);
 
+    //Every corner and edge exists exactly once and the twists, flips and permutation parities add up, so the cube can
+    //be reached from the solved one. Scanned cubes can easily break this with a single misread sticker
+    [[nodiscard]] bool isSolvable() const;
+
     void saveNetImage(const char* filename);
 
     inline bool operator==(const RubiksCube& other) const {
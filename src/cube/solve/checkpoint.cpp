@@ -0,0 +1,131 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#include "checkpoint.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+struct CheckpointState {
+    int32_t depth;
+    int32_t tableDepth;
+    uint64_t frontierSize;
+    uint64_t processed;
+};
+
+TableCheckpoint::TableCheckpoint(std::string dir, uint8_t* table, uint64_t tableSize)
+    :dir(std::move(dir)), table(table), tableSize(tableSize)
+{
+    std::ifstream in(this->dir + "/state.bin", std::ios::binary);
+    if (!in) {
+        return;
+    }
+
+    CheckpointState state;
+    in.read((char*) &state, sizeof(CheckpointState));
+    if (in.gcount() != sizeof(CheckpointState)) {
+        std::cout << "Ignoring broken checkpoint in " << this->dir << std::endl;
+        return;
+    }
+
+    savedState = true;
+    depth = state.depth;
+    tableDepth = state.tableDepth;
+    frontierSize = state.frontierSize;
+    processed = state.processed;
+}
+
+std::string TableCheckpoint::getFilePath(const std::string& name, int fileDepth) const {
+    return dir + "/" + name + "-" + std::to_string(fileDepth) + ".bin";
+}
+
+std::string TableCheckpoint::getFilePath(const std::string& name) const {
+    return dir + "/" + name + ".dat";
+}
+
+void TableCheckpoint::loadTable() {
+    if (tableDepth >= 0) {
+        readFile(getFilePath("table", tableDepth), table, tableSize);
+    }
+}
+
+void TableCheckpoint::commit(int newDepth, uint64_t newFrontierSize, uint64_t newProcessed, bool saveTable) {
+    if (saveTable) {
+        writeFile(getFilePath("table", newDepth), table, tableSize);
+        tableDepth = newDepth;
+    }
+
+    CheckpointState state{newDepth, tableDepth, newFrontierSize, newProcessed};
+    writeFile(dir + "/state.tmp", &state, sizeof(CheckpointState));
+    std::filesystem::rename(dir + "/state.tmp", dir + "/state.bin");
+
+    savedState = true;
+    depth = newDepth;
+    frontierSize = newFrontierSize;
+    processed = newProcessed;
+
+    //Files from older depths aren't needed anymore
+    std::string keep = std::filesystem::path(getFilePath("table", tableDepth)).filename().string();
+    for (const auto& entry: std::filesystem::directory_iterator(dir)) {
+        std::string name = entry.path().filename().string();
+        if (entry.path().extension() != ".bin" || name == keep) continue;
+
+        size_t dash = name.rfind('-');
+        if (dash == std::string::npos) continue;
+
+        int fileDepth = std::atoi(name.substr(dash + 1).c_str());
+        if (fileDepth < newDepth) {
+            std::filesystem::remove(entry.path());
+        }
+    }
+}
+
+void TableCheckpoint::clear() {
+    std::filesystem::remove_all(dir);
+    savedState = false;
+}
+
+void TableCheckpoint::writeFile(const std::string& path, const void* data, uint64_t size) {
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+
+    std::ofstream out(path, std::ios::binary);
+    out.write((const char*) data, size);
+    out.close();
+
+    if (!out) {
+        std::cerr << "Couldn't write " << path << std::endl;
+        exit(1);
+    }
+}
+
+void TableCheckpoint::readFile(const std::string& path, void* data, uint64_t size) {
+    std::ifstream in(path, std::ios::binary);
+    in.read((char*) data, size);
+
+    if (!in) {
+        std::cerr << "Couldn't read " << path << std::endl;
+        exit(1);
+    }
+}
+
+void TableCheckpoint::writeBits(const std::string& path, const std::vector<bool>& bits) {
+    std::vector<uint8_t> packed((bits.size() + 7) / 8, 0);
+    for (size_t i = 0; i < bits.size(); i++) {
+        if (bits[i]) {
+            packed[i / 8] |= 1 << (i % 8);
+        }
+    }
+
+    writeFile(path, packed.data(), packed.size());
+}
+
+void TableCheckpoint::readBits(const std::string& path, std::vector<bool>& bits) {
+    std::vector<uint8_t> packed((bits.size() + 7) / 8);
+    readFile(path, packed.data(), packed.size());
+
+    for (size_t i = 0; i < bits.size(); i++) {
+        bits[i] = (packed[i / 8] >> (i % 8)) & 1;
+    }
+}
@@ -0,0 +1,74 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_CHECKPOINT_H
+#define RUBIK_CHECKPOINT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Lets a table generator save its progress after every completed BFS depth so an interrupted build can pick up where
+ * it left off instead of starting from scratch.
+ *
+ * Everything lives in one directory next to the table. Files belonging to a depth are named <name>-<depth>.bin, and
+ * state.bin says which depth is the latest complete one. state.bin is only replaced once every other file of the new
+ * depth has been written, and older depths are only removed after that, so a crash at any point leaves a usable
+ * checkpoint behind.
+ */
+class TableCheckpoint {
+public:
+    TableCheckpoint(std::string dir, uint8_t* table, uint64_t tableSize);
+
+    [[nodiscard]] bool hasSavedState() const {
+        return savedState;
+    }
+
+    //Only meaningful if hasSavedState()
+    [[nodiscard]] int getDepth() const {
+        return depth;
+    }
+
+    [[nodiscard]] uint64_t getFrontierSize() const {
+        return frontierSize;
+    }
+
+    [[nodiscard]] uint64_t getProcessed() const {
+        return processed;
+    }
+
+    //Path of a file belonging to the given depth, removed automatically once a later depth is committed
+    [[nodiscard]] std::string getFilePath(const std::string& name, int fileDepth) const;
+    //Path of a file that is kept until the checkpoint is cleared
+    [[nodiscard]] std::string getFilePath(const std::string& name) const;
+
+    //Copies the partially filled table of the saved depth into the table
+    void loadTable();
+
+    //Marks depth as complete. Everything the generator needs for it has to be written already
+    void commit(int newDepth, uint64_t newFrontierSize, uint64_t newProcessed, bool saveTable = true);
+
+    //Removes the whole checkpoint, called once the table has been saved
+    void clear();
+
+    static void writeFile(const std::string& path, const void* data, uint64_t size);
+    static void readFile(const std::string& path, void* data, uint64_t size);
+
+    static void writeBits(const std::string& path, const std::vector<bool>& bits);
+    static void readBits(const std::string& path, std::vector<bool>& bits);
+
+private:
+    std::string dir;
+    uint8_t* table;
+    uint64_t tableSize;
+
+    bool savedState = false;
+    int depth = 0;
+    uint64_t frontierSize = 0;
+    uint64_t processed = 0;
+    int tableDepth = -1;
+};
+
+#endif //RUBIK_CHECKPOINT_H
@@ -6,7 +6,12 @@
 #include <iostream>
 #include <chrono>
 #include <filesystem>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <type_traits>
 #include "cube/FastRubiksCube.h"
+#include "checkpoint.h"
 
 template<typename T>
 struct BasicSerializer {
@@ -19,54 +24,148 @@ struct BasicSerializer {
     }
 };
 
+//Tables bigger than this are loaded on a background thread by preload
+const uint64_t ASYNC_LOAD_THRESHOLD = 16 * 1024 * 1024;
+
 template<typename T, typename Serializer = BasicSerializer<T>>
 class Database {
 public:
     uint64_t size;
     std::string path;
     std::function<void (T*)> loader;
+    //Loaders that take a checkpoint save their progress as they go, and get handed the saved progress after a restart
+    std::function<void (T*, TableCheckpoint&)> resumableLoader;
     T* ptr = nullptr;
 
     Database(uint64_t size, std::string path, std::function<void (T*)> loader) : size(size), path(std::move(path)), loader(std::move(loader)) {}
+    Database(uint64_t size, std::string path, std::function<void (T*, TableCheckpoint&)> loader) : size(size), path(std::move(path)), resumableLoader(std::move(loader)) {}
 
     ~Database() {
+        if (loadThread.joinable()) {
+            loadThread.join();
+        }
+
         if (ptr) {
             delete ptr;
         }
     }
 
+    //Safe to call from any thread, if the table is being loaded somewhere else this waits for it to finish
     void ensureLoaded() {
-        if (!ptr) {
-            this->ptr = (T*) malloc(size);
+        if (loaded) return;
+
+        std::lock_guard<std::mutex> lock(loadMutex);
+        if (!loaded) {
+            load();
+            loaded = true;
+        }
+    }
+
+    //Starts loading the table on a background thread, anything that needs it still has to call ensureLoaded
+    void loadAsync() {
+        if (loaded || loadThread.joinable()) return;
 
+        loadThread = std::thread([this]() {
+            ensureLoaded();
+        });
+    }
+
+    //Small tables are loaded right away, big ones in the background
+    void preload() {
+        if (size < ASYNC_LOAD_THRESHOLD) {
+            ensureLoaded();
+        } else {
+            loadAsync();
+        }
+    }
+
+    [[nodiscard]] bool isLoaded() const {
+        return loaded;
+    }
+
+private:
+    std::atomic<bool> loaded = false;
+    std::mutex loadMutex;
+    std::thread loadThread;
+
+    //False if there is no saved table or it's incomplete, in which case it's deleted and generated again
+    bool readTable() {
+        std::error_code error;
+        uint64_t fileSize = std::filesystem::file_size(path, error);
+        if (error) return false;
+
+        //Raw tables are exactly size bytes, the others can only be checked by reading them
+        bool complete = !std::is_same_v<Serializer, BasicSerializer<T>> || fileSize == size;
+
+        if (complete) {
             std::ifstream in(path, std::ios::binary);
-            if (in) {
-                Serializer::deserialize(this->ptr, size, in);
-                in.close();
-                std::cout << "Loaded " << path << std::endl;
-                return;
+            Serializer::deserialize(this->ptr, size, in);
+            complete = in && in.peek() == std::ifstream::traits_type::eof();
+        }
+
+        if (!complete) {
+            std::cout << path << " is incomplete, discarding it" << std::endl;
+            std::filesystem::remove(path, error);
+        }
+
+        return complete;
+    }
+
+    void load() {
+        this->ptr = (T*) malloc(size);
+
+        if (readTable()) {
+            std::cout << "Loaded " << path << std::endl;
+            return;
+        }
+
+        TableCheckpoint checkpoint(path + ".checkpoint", (uint8_t*) this->ptr, size);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        if (resumableLoader) {
+            if (checkpoint.hasSavedState()) {
+                std::cout << "Resuming " << path << " from depth " << checkpoint.getDepth() << std::endl;
+                checkpoint.loadTable();
+            } else {
+                std::cout << "Need to generate " << path << std::endl;
             }
 
+            resumableLoader(this->ptr, checkpoint);
+        } else {
             std::cout << "Need to generate " << path << std::endl;
-            auto start = std::chrono::high_resolution_clock::now();
             loader(this->ptr);
-            auto end = std::chrono::high_resolution_clock::now();
-
-            std::cout << "Finished generating!" << std::endl;
-            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-            std::cout << "Took " << elapsed << " milliseconds!" << std::endl;
-
-            std::filesystem::path filePath = path;
-            std::filesystem::create_directories(filePath.parent_path());
-            std::ofstream out(path, std::ios::binary);
-            if (!out) {
-                std::cerr << "Couldn't open " << path << "\n";
-                exit(1);
-            }
-            Serializer::serialize(this->ptr, size, out);
-            out.close();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        std::cout << "Finished generating!" << std::endl;
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+        std::cout << "Took " << elapsed << " milliseconds!" << std::endl;
+
+        //Written next to the table and renamed over it once complete, so dying halfway never leaves a truncated table
+        //that the next start would take as finished
+        std::filesystem::path filePath = path;
+        std::filesystem::create_directories(filePath.parent_path());
+        std::string tempPath = path + ".tmp";
+
+        std::ofstream out(tempPath, std::ios::binary);
+        if (!out) {
+            std::cerr << "Couldn't open " << tempPath << "\n";
+            exit(1);
+        }
+        Serializer::serialize(this->ptr, size, out);
+        out.close();
+
+        if (!out) {
+            std::cerr << "Couldn't write " << tempPath << "\n";
+            exit(1);
+        }
+
+        std::filesystem::rename(tempPath, path);
+
+        std::cout << "Saved " << path << std::endl;
 
-            std::cout << "Saved " << path << std::endl;
+        if (resumableLoader) {
+            checkpoint.clear();
         }
     }
 };
@@ -0,0 +1,257 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#include "evaluation.h"
+#include "kociemba.h"
+#include "cube/RandomCube.h"
+#include "util/Statistics.h"
+#include "util/WorkStealing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock EvalClock;
+
+struct SolveRecord {
+    //-1 if nothing was found before the deadline
+    int length = -1;
+    double firstMs = -1;
+    double bestMs = -1;
+    double totalMs = 0;
+    uint64_t nodes = 0;
+
+    //(ms since the start, length) every time the solution got shorter
+    std::vector<std::pair<double, int>> improvements;
+};
+
+//The search only looks at a halt flag, so a watchdog sets it once a worker's deadline has passed
+struct alignas(64) WorkerSlot {
+    std::mutex mutex;
+    EvalClock::time_point deadline = EvalClock::time_point::max();
+    //Polled by the search without the mutex
+    std::atomic<bool> halt = false;
+};
+
+static double millisSince(EvalClock::time_point start) {
+    return std::chrono::duration<double, std::milli>(EvalClock::now() - start).count();
+}
+
+static void solveWithDeadline(const FastRubiksCube& cube, WorkerSlot& slot, std::chrono::milliseconds deadline, SolveRecord& record) {
+    auto start = EvalClock::now();
+    {
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        slot.halt = false;
+        slot.deadline = start + deadline;
+    }
+
+    uint64_t startNodes = getKociembaNodeCount();
+    int bestLength = 1000;
+
+    searchKociemba(cube, slot.halt, bestLength - 1, [&](std::vector<int>& solution) {
+        if ((int) solution.size() < bestLength) {
+            bestLength = solution.size();
+            record.improvements.push_back({millisSince(start), bestLength});
+        }
+
+        return bestLength - 1;
+    });
+
+    {
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        slot.deadline = EvalClock::time_point::max();
+    }
+
+    record.totalMs = millisSince(start);
+    record.nodes = getKociembaNodeCount() - startNodes;
+
+    if (!record.improvements.empty()) {
+        record.length = bestLength;
+        record.firstMs = record.improvements.front().first;
+        record.bestMs = record.improvements.back().first;
+    }
+}
+
+static void writeCSV(const std::string& path, const std::vector<SolveRecord>& records) {
+    std::ofstream out(path);
+
+    if (!out) {
+        std::cerr << "Couldn't open " << path << std::endl;
+        exit(1);
+    }
+
+    out << "Cube,Length,First (ms),Best (ms),Total (ms),Nodes,Improvements" << std::endl;
+
+    for (size_t i = 0; i < records.size(); i++) {
+        const SolveRecord& record = records[i];
+        out << i << "," << record.length << "," << record.firstMs << "," << record.bestMs << "," << record.totalMs << "," << record.nodes << ",";
+
+        for (size_t j = 0; j < record.improvements.size(); j++) {
+            if (j) out << " ";
+            out << record.improvements[j].first << ":" << record.improvements[j].second;
+        }
+
+        out << std::endl;
+    }
+}
+
+static void writePercentiles(std::ostream& out, std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+
+    out << "{\"p50\": " << percentile(values, 0.5) << ", \"p90\": " << percentile(values, 0.9)
+        << ", \"p99\": " << percentile(values, 0.99) << ", \"p999\": " << percentile(values, 0.999)
+        << ", \"max\": " << percentile(values, 1) << "}";
+}
+
+static void writeJSON(const std::string& path, const EvaluationConfig& config, int numThreads, double wallSeconds, const std::vector<SolveRecord>& records) {
+    std::ofstream out(path);
+
+    if (!out) {
+        std::cerr << "Couldn't open " << path << std::endl;
+        exit(1);
+    }
+
+    std::map<int, int> histogram;
+    std::vector<double> firstTimes;
+    std::vector<double> bestTimes;
+    std::vector<double> totalTimes;
+    uint64_t totalNodes = 0;
+    double searchSeconds = 0;
+    size_t failed = 0;
+    double lengthSum = 0;
+
+    for (const SolveRecord& record: records) {
+        totalNodes += record.nodes;
+        searchSeconds += record.totalMs / 1000;
+        totalTimes.push_back(record.totalMs);
+
+        if (record.length == -1) {
+            failed++;
+            continue;
+        }
+
+        histogram[record.length]++;
+        lengthSum += record.length;
+        firstTimes.push_back(record.firstMs);
+        bestTimes.push_back(record.bestMs);
+    }
+
+    out << "{" << std::endl;
+    out << "  \"cubes\": " << config.numCubes << "," << std::endl;
+    out << "  \"seed\": " << config.seed << "," << std::endl;
+    out << "  \"deadline_ms\": " << config.deadline.count() << "," << std::endl;
+    out << "  \"threads\": " << numThreads << "," << std::endl;
+    out << "  \"wall_seconds\": " << wallSeconds << "," << std::endl;
+    out << "  \"failed\": " << failed << "," << std::endl;
+    out << "  \"mean_length\": " << (records.size() > failed ? lengthSum / (records.size() - failed) : -1) << "," << std::endl;
+    //All threads together, and what one thread gets through while it's searching
+    out << "  \"nodes_per_second\": " << (wallSeconds > 0 ? totalNodes / wallSeconds : 0) << "," << std::endl;
+    out << "  \"nodes_per_thread_second\": " << (searchSeconds > 0 ? totalNodes / searchSeconds : 0) << "," << std::endl;
+    out << "  \"solves_per_second\": " << (wallSeconds > 0 ? records.size() / wallSeconds : 0) << "," << std::endl;
+
+    out << "  \"length_histogram\": {";
+    for (auto it = histogram.begin(); it != histogram.end(); it++) {
+        if (it != histogram.begin()) out << ", ";
+        out << "\"" << it->first << "\": " << it->second;
+    }
+    out << "}," << std::endl;
+
+    out << "  \"first_solution_ms\": ";
+    writePercentiles(out, firstTimes);
+    out << "," << std::endl;
+    out << "  \"best_solution_ms\": ";
+    writePercentiles(out, bestTimes);
+    out << "," << std::endl;
+    out << "  \"total_ms\": ";
+    writePercentiles(out, totalTimes);
+    out << "," << std::endl;
+
+    //How long it takes until a solution of at most this many moves is known, over the cubes that got there at all
+    out << "  \"time_to_length_ms\": {";
+    if (!histogram.empty()) {
+        int shortest = histogram.begin()->first;
+        int longest = 0;
+        for (const SolveRecord& record: records) {
+            if (!record.improvements.empty()) {
+                longest = std::max(longest, record.improvements.front().second);
+            }
+        }
+
+        for (int length = longest; length >= shortest; length--) {
+            std::vector<double> times;
+            for (const SolveRecord& record: records) {
+                for (const auto& [ms, improvedLength]: record.improvements) {
+                    if (improvedLength <= length) {
+                        times.push_back(ms);
+                        break;
+                    }
+                }
+            }
+
+            if (length != longest) out << ",";
+            out << std::endl << "    \"" << length << "\": {\"reached\": " << times.size() << ", \"latency\": ";
+            writePercentiles(out, times);
+            out << "}";
+        }
+        out << std::endl << "  ";
+    }
+    out << "}" << std::endl;
+    out << "}" << std::endl;
+}
+
+void runEvaluation(const EvaluationConfig& config) {
+    int numThreads = config.numThreads > 0 ? config.numThreads : (int) std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "Loading Kociemba tables" << std::endl;
+    ensureKociembaTablesLoaded();
+
+    std::vector<FastRubiksCube> cubes = generateRandomCubes(config.numCubes, config.seed, numThreads);
+    std::vector<SolveRecord> records(config.numCubes);
+
+    std::vector<WorkerSlot> slots(numThreads);
+    std::atomic<int> finished = 0;
+    std::atomic<bool> done = false;
+
+    std::thread watchdog([&]() {
+        while (!done) {
+            auto now = EvalClock::now();
+
+            for (WorkerSlot& slot: slots) {
+                std::lock_guard<std::mutex> lock(slot.mutex);
+                if (now >= slot.deadline) {
+                    slot.halt = true;
+                }
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    auto start = EvalClock::now();
+
+    runWorkStealing(numThreads, config.numCubes, [&](int i, int thread) {
+        solveWithDeadline(cubes[i], slots[thread], config.deadline, records[i]);
+
+        int count = ++finished;
+        if (count % 100 == 0) {
+            std::cout << "Solved " << count << "/" << config.numCubes << " cubes" << std::endl;
+        }
+    });
+
+    double wallSeconds = millisSince(start) / 1000;
+
+    done = true;
+    watchdog.join();
+
+    writeCSV(config.csvPath, records);
+    writeJSON(config.jsonPath, config, numThreads, wallSeconds, records);
+
+    std::cout << "Evaluated " << config.numCubes << " cubes in " << wallSeconds << "s, results in " << config.csvPath << " and " << config.jsonPath << std::endl;
+}
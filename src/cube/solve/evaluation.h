@@ -0,0 +1,32 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_EVALUATION_H
+#define RUBIK_EVALUATION_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/*
+ * Benchmarks the Kociemba solver the way it runs in production: uniformly random cubes, each searched until its
+ * deadline, on every core. Every solve is written to a CSV file and the summary (length histogram, time to reach each
+ * length, nodes/s overall and per thread, latency percentiles) to a JSON file, so runs from different commits can be
+ * compared directly.
+ */
+
+struct EvaluationConfig {
+    int numCubes = 1000;
+    uint64_t seed = 1;
+    std::chrono::milliseconds deadline{100};
+    //0 for one per core
+    int numThreads = 0;
+
+    std::string csvPath = "evaluation.csv";
+    std::string jsonPath = "evaluation.json";
+};
+
+void runEvaluation(const EvaluationConfig& config);
+
+#endif //RUBIK_EVALUATION_H
@@ -5,8 +5,15 @@
 #include "database.h"
 #include "solver_util.h"
 #include "util/RedundantMovePreventor.h"
+#include "cube/CubeKernels.h"
+#include "symmetry.h"
+#include "solution_optimizer.h"
+#include "cube/RandomCube.h"
 
+#include <algorithm>
+#include <array>
 #include <bitset>
+#include <limits>
 #include <vector>
 #include <utility>
 #include <iostream>
@@ -34,166 +41,8 @@ constexpr std::bitset<12> cornerMask(std::array<Edge, Size> edges) {
     return mask;
 }
 
-constexpr
-FastRubiksCube makeCube(std::array<std::pair<Corner, std::pair<Corner, int>>, 8> cornerPerm, std::array<std::pair<Edge, std::pair<Edge, int>>, 12> edgePerm) {
-    FastRubiksCube res = {};
-
-    for (int i = 0; i < 8; i++) {
-        res.corners[cornerPerm[i].first] = cornerPerm[i].second.first;
-        res.cornerOrientations[cornerPerm[i].second.first] = cornerPerm[i].second.second;
-    }
-
-    for (int i = 0; i < 12; i++) {
-        res.edges[edgePerm[i].first] = edgePerm[i].second.first;
-        res.edgeOrientations[edgePerm[i].second.first] = edgePerm[i].second.second;
-    }
-
-    return res;
-}
-
 const std::bitset<12> UD_MASK = cornerMask<4>({Edge::FRONT_LEFT, Edge::FRONT_RIGHT, Edge::BACK_LEFT, Edge::BACK_RIGHT});
 
-const FastRubiksCube S_F2 = makeCube(
-        std::array<std::pair<Corner, std::pair<Corner, int>>, 8>{
-                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_RIGHT_FRONT, {Corner::BOTTOM_LEFT_FRONT, 0}},
-                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_LEFT_FRONT,  {Corner::TOP_RIGHT_FRONT,  0}},
-
-                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_LEFT_FRONT, {Corner::BOTTOM_RIGHT_FRONT, 0}},
-                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_RIGHT_FRONT,  {Corner::TOP_LEFT_FRONT,  0}},
-
-                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_RIGHT_BACK, {Corner::BOTTOM_LEFT_BACK, 0}},
-                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_LEFT_BACK,  {Corner::TOP_RIGHT_BACK,  0}},
-
-                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_LEFT_BACK, {Corner::BOTTOM_RIGHT_BACK, 0}},
-                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_RIGHT_BACK,  {Corner::TOP_LEFT_BACK,  0}},
-        },
-
-        {
-                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_FRONT, {Edge::BOTTOM_FRONT, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_FRONT, {Edge::TOP_FRONT, 0}},
-
-                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_RIGHT, {Edge::BOTTOM_LEFT, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_LEFT, {Edge::TOP_RIGHT, 0}},
-
-                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_LEFT, {Edge::BOTTOM_RIGHT, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_RIGHT, {Edge::TOP_LEFT, 0}},
-
-                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_BACK, {Edge::BOTTOM_BACK, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_BACK, {Edge::TOP_BACK, 0}},
-
-                std::pair<Edge, std::pair<Edge, int>>{Edge::FRONT_LEFT, {Edge::FRONT_RIGHT, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::FRONT_RIGHT, {Edge::FRONT_LEFT, 0}},
-
-                std::pair<Edge, std::pair<Edge, int>>{Edge::BACK_LEFT, {Edge::BACK_RIGHT, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::BACK_RIGHT, {Edge::BACK_LEFT, 0}},
-        }
-);
-
-//Clockwise turn of cube around U axis
-const FastRubiksCube S_U4 = makeCube(
-        std::array<std::pair<Corner, std::pair<Corner, int>>, 8>{
-                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_RIGHT_FRONT, {Corner::TOP_LEFT_FRONT, 0}},
-                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_LEFT_FRONT,  {Corner::TOP_LEFT_BACK,  0}},
-                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_LEFT_BACK,   {Corner::TOP_RIGHT_BACK, 0}},
-                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_RIGHT_BACK,  {Corner::TOP_RIGHT_FRONT, 0}},
-
-                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_RIGHT_FRONT, {Corner::BOTTOM_LEFT_FRONT, 0}},
-                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_LEFT_FRONT,  {Corner::BOTTOM_LEFT_BACK,  0}},
-                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_LEFT_BACK,   {Corner::BOTTOM_RIGHT_BACK, 0}},
-                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_RIGHT_BACK,  {Corner::BOTTOM_RIGHT_FRONT, 0}}
-        },
-
-        std::array<std::pair<Edge, std::pair<Edge, int>>, 12> {
-                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_FRONT, {Edge::TOP_LEFT, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_LEFT,  {Edge::TOP_BACK, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_BACK,  {Edge::TOP_RIGHT, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_RIGHT, {Edge::TOP_FRONT, 0}},
-
-                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_FRONT, {Edge::BOTTOM_LEFT, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_LEFT,  {Edge::BOTTOM_BACK, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_BACK,  {Edge::BOTTOM_RIGHT, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_RIGHT, {Edge::BOTTOM_FRONT, 0}},
-
-                std::pair<Edge, std::pair<Edge, int>>{Edge::FRONT_LEFT,  {Edge::BACK_LEFT, 1}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::BACK_LEFT,   {Edge::BACK_RIGHT, 1}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::BACK_RIGHT,  {Edge::FRONT_RIGHT, 1}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::FRONT_RIGHT, {Edge::FRONT_LEFT, 1}}
-        }
-);
-
-const FastRubiksCube S_LR2_BASE = makeCube(
-        std::array<std::pair<Corner, std::pair<Corner, int>>, 8>{
-                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_RIGHT_FRONT, {Corner::TOP_LEFT_FRONT, 0}},
-                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_LEFT_FRONT,  {Corner::TOP_RIGHT_FRONT, 0}},
-
-                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_RIGHT_BACK,  {Corner::TOP_LEFT_BACK,  0}},
-                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_LEFT_BACK,   {Corner::TOP_RIGHT_BACK,  0}},
-
-                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_RIGHT_FRONT, {Corner::BOTTOM_LEFT_FRONT, 0}},
-                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_LEFT_FRONT,  {Corner::BOTTOM_RIGHT_FRONT, 0}},
-
-                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_RIGHT_BACK,  {Corner::BOTTOM_LEFT_BACK,  0}},
-                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_LEFT_BACK,   {Corner::BOTTOM_RIGHT_BACK,  0}}
-        },
-
-        std::array<std::pair<Edge, std::pair<Edge, int>>, 12> {
-                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_FRONT, {Edge::TOP_FRONT, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_BACK, {Edge::TOP_BACK, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_FRONT, {Edge::BOTTOM_FRONT, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_BACK, {Edge::BOTTOM_BACK, 0}},
-
-                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_LEFT,  {Edge::TOP_RIGHT, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_RIGHT, {Edge::TOP_LEFT, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_LEFT,  {Edge::BOTTOM_RIGHT, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_RIGHT, {Edge::BOTTOM_LEFT, 0}},
-
-                std::pair<Edge, std::pair<Edge, int>>{Edge::FRONT_LEFT,  {Edge::FRONT_RIGHT, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::FRONT_RIGHT, {Edge::FRONT_LEFT, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::BACK_LEFT,  {Edge::BACK_RIGHT, 0}},
-                std::pair<Edge, std::pair<Edge, int>>{Edge::BACK_RIGHT, {Edge::BACK_LEFT, 0}}
-        }
-);
-
-FastRubiksCube apply_S_F2(const FastRubiksCube& cube) {
-    return cube.applyBasicSymmetry(S_F2);
-}
-
-FastRubiksCube apply_S_U4(const FastRubiksCube& cube) {
-    return cube.applyBasicSymmetry(S_U4);
-}
-
-FastRubiksCube apply_S_LR2(const FastRubiksCube& cube) {
-    FastRubiksCube res = cube.applyBasicSymmetry(S_LR2_BASE);
-
-    for (int i = 0; i < 8; i++) {
-        res.cornerOrientations[i] = (3 - res.cornerOrientations[i]) % 3;
-    }
-
-    return res;
-}
-
-FastRubiksCube applySymmetry(const FastRubiksCube& cube, int idx) {
-    FastRubiksCube res = cube;
-
-    if (idx >= 8) {
-        res = apply_S_LR2(res);
-        idx -= 8;
-    }
-
-    while (idx >= 2) {
-        res = apply_S_U4(res);
-        idx -= 2;
-    }
-
-    if (idx == 1) {
-        res = apply_S_F2(res);
-    }
-
-    return res;
-}
-int REVERSE_SYMMETRIES[16];
-int SYM_MULT[16][16];
-
 FastRubiksCube reduceTest(const FastRubiksCube& cube) {
     FastRubiksCube best = cube;
 
@@ -285,24 +134,19 @@ uint32_t cornerPermutationCoordinate(const FastRubiksCube &cube) {
 const uint8_t phase2EdgePermIndices[12] = {0, 1, 2, 3, 255, 255, 255, 255, 4, 5, 6, 7};
 const uint8_t phase2EdgePermTargetEdges[8] = {0, 1, 2, 3, 8, 9, 10, 11};
 uint32_t phase2EdgePermutationCoordinate(const FastRubiksCube &cube) {
-    uint32_t seen = 0;
-    uint32_t res = 0;
+    uint8_t values[8];
 
     for (int i = 0; i < 8; i++) {
-        int v = phase2EdgePermIndices[cube.edges[phase2EdgePermTargetEdges[i]]];
+        values[i] = phase2EdgePermIndices[cube.edges[phase2EdgePermTargetEdges[i]]];
 
 #ifdef _DEBUG
-        if (v == 255) {
+        if (values[i] == 255) {
             std::cout << "Invalid edge permutation" << std::endl;
         }
 #endif
-
-        int count = BIT_COUNT_U16[seen >> (8 - v)];
-        res += (v - count) * FACTORIAL_U32[7 - i];
-        seen |= (1 << (7 - v));
     }
 
-    return res;
+    return rankPermutation(values, 8, 8);
 }
 
 const uint8_t phase2UDSliceEdgeIndices[12] = {
@@ -312,24 +156,19 @@ const uint8_t phase2UDSliceEdgeIndices[12] = {
 };
 const uint8_t phase2UDSliceEdgeTargetEdges[4] = {4, 5, 6, 7};
 uint32_t phase2UDSliceCoordinate(const FastRubiksCube &cube) {
-    uint32_t seen = 0;
-    uint32_t res = 0;
+    uint8_t values[4];
 
     for (int i = 0; i < 4; i++) {
-        int v = phase2UDSliceEdgeIndices[cube.edges[phase2UDSliceEdgeTargetEdges[i]]];
+        values[i] = phase2UDSliceEdgeIndices[cube.edges[phase2UDSliceEdgeTargetEdges[i]]];
 
 #ifdef _DEBUG
-        if (v == 255) {
+        if (values[i] == 255) {
             std::cout << "Invalid UDSlice permutation" << std::endl;
         }
 #endif
-
-        int count = BIT_COUNT_U16[seen >> (4 - v)];
-        res += (v - count) * FACTORIAL_U32[3 - i];
-        seen |= (1 << (3 - v));
     }
 
-    return res;
+    return rankPermutation(values, 4, 4);
 }
 
 
@@ -508,7 +347,7 @@ struct SymMoveTable {
         int j = symCoord / 16;
         int i = symCoord % 16;
 
-        int m1 = symMoves[REVERSE_SYMMETRIES[i]][move];
+        int m1 = SYM_MOVES[REVERSE_SYMMETRIES[i]][move];
 
         int m1_times_rj = tables[j].moves[m1];
         int i1 = m1_times_rj % 16;
@@ -589,31 +428,8 @@ void constructSymMoveTable(SymMoveTable* out, std::function<uint32_t (const Fast
         }
     }
 
-    FastRubiksCube moves[18];
-    for (int i = 0; i < availableMoves.size(); i++) {
-        moves[availableMoves[i]] = FastRubiksCube().doMove(availableMoves[i]);
-    }
-
-    for (int i: availableMoves) {
-        for (int j = 0; j < 16; j++) {
-            FastRubiksCube sym = applySymmetry(moves[i], j);
-
-            uint8_t moveIdx = -1;
-            for (int k: availableMoves) {
-                if (sym == moves[k]) {
-                    moveIdx = k;
-                    break;
-                }
-            }
-
-            if (moveIdx == -1) {
-                std::cout << "Error: move not found" << std::endl;
-                exit(1);
-            }
-
-            out->symMoves[j][i] = moveIdx;
-        }
-    }
+    //Only kept in the file for compatibility, doMove uses SYM_MOVES directly
+    memcpy(out->symMoves, SYM_MOVES, sizeof(out->symMoves));
 }
 
 Database<SymCoordLookup, SymCoordLookupSerializer> FLIP_UD_SLICE_SYM_COORDS(
@@ -827,44 +643,86 @@ struct SuperFastPhaseTwoCube {
     }
 };
 
-void constructPhaseOnePruningTable(PhaseOnePruningTable* out) {
-    performBFSDisk<SuperFastPhaseOneCube>(
-            SuperFastPhaseOneCube(FastRubiksCube()),
-            sizeof(PhaseOnePruningTable) / sizeof(uint8_t),
-            [](const SuperFastPhaseOneCube& state) {
-                return state.getPruningCoord();
-            },
-            [](const SuperFastPhaseOneCube& state) {
-                std::vector<SuperFastPhaseOneCube> res;
-                for (int i = 0; i < 18; i++) {
-                    res.push_back(state.doMove(i));
-                }
-                return res;
-            },
-            [&](uint8_t depth, uint64_t idx, const SuperFastPhaseOneCube& state) {
-                out->lookup[idx] = depth;
-            }
-    );
+void constructPhaseOnePruningTable(PhaseOnePruningTable* out, TableCheckpoint& checkpoint) {
+    std::function<uint64_t (const SuperFastPhaseOneCube&)> stateToIndex = [](const SuperFastPhaseOneCube& state) {
+        return state.getPruningCoord();
+    };
+    std::function<std::vector<SuperFastPhaseOneCube> (const SuperFastPhaseOneCube&)> getNextStates = [](const SuperFastPhaseOneCube& state) {
+        std::vector<SuperFastPhaseOneCube> res;
+        for (int i = 0; i < 18; i++) {
+            res.push_back(state.doMove(i));
+        }
+        return res;
+    };
+
+    if (useExternalBFS()) {
+        performBFSExternal<SuperFastPhaseOneCube>(
+                SuperFastPhaseOneCube(FastRubiksCube()),
+                sizeof(PhaseOnePruningTable) / sizeof(uint8_t),
+                stateToIndex,
+                [](uint64_t idx) {
+                    //Taking the identity symmetry of the class gives back exactly this pruning coord
+                    return SuperFastPhaseOneCube((idx / 2187) << 4, idx % 2187);
+                },
+                getNextStates,
+                [&](uint8_t depth, uint64_t idx) {
+                    out->lookup[idx] = depth;
+                },
+                &checkpoint
+        );
+    } else {
+        performBFSDisk<SuperFastPhaseOneCube>(
+                SuperFastPhaseOneCube(FastRubiksCube()),
+                sizeof(PhaseOnePruningTable) / sizeof(uint8_t),
+                stateToIndex,
+                getNextStates,
+                [&](uint8_t depth, uint64_t idx, const SuperFastPhaseOneCube& state) {
+                    out->lookup[idx] = depth;
+                },
+                &checkpoint
+        );
+    }
 }
 
-void constructPhaseTwoPruningTable(PhaseTwoPruningTable* out) {
-    performBFSDisk<SuperFastPhaseTwoCube>(
-            SuperFastPhaseTwoCube(FastRubiksCube()),
-            sizeof(PhaseTwoPruningTable) / sizeof(uint8_t),
-            [](const SuperFastPhaseTwoCube& state) {
-                return state.getPruningCoord();
-            },
-            [](const SuperFastPhaseTwoCube& state) {
-                std::vector<SuperFastPhaseTwoCube> res;
-                for (int i : PHASE_TWO_MOVES) {
-                    res.push_back(state.doMove(i));
-                }
-                return res;
-            },
-            [&](uint8_t depth, uint64_t idx, const SuperFastPhaseTwoCube& state) {
-                out->lookup[idx] = depth;
-            }
-    );
+void constructPhaseTwoPruningTable(PhaseTwoPruningTable* out, TableCheckpoint& checkpoint) {
+    std::function<uint64_t (const SuperFastPhaseTwoCube&)> stateToIndex = [](const SuperFastPhaseTwoCube& state) {
+        return state.getPruningCoord();
+    };
+    std::function<std::vector<SuperFastPhaseTwoCube> (const SuperFastPhaseTwoCube&)> getNextStates = [](const SuperFastPhaseTwoCube& state) {
+        std::vector<SuperFastPhaseTwoCube> res;
+        for (int i : PHASE_TWO_MOVES) {
+            res.push_back(state.doMove(i));
+        }
+        return res;
+    };
+
+    if (useExternalBFS()) {
+        performBFSExternal<SuperFastPhaseTwoCube>(
+                SuperFastPhaseTwoCube(FastRubiksCube()),
+                sizeof(PhaseTwoPruningTable) / sizeof(uint8_t),
+                stateToIndex,
+                [](uint64_t idx) {
+                    //The pruning coord doesn't depend on the UD slice, so any value works there
+                    return SuperFastPhaseTwoCube((idx / 40320) << 4, idx % 40320, 0);
+                },
+                getNextStates,
+                [&](uint8_t depth, uint64_t idx) {
+                    out->lookup[idx] = depth;
+                },
+                &checkpoint
+        );
+    } else {
+        performBFSDisk<SuperFastPhaseTwoCube>(
+                SuperFastPhaseTwoCube(FastRubiksCube()),
+                sizeof(PhaseTwoPruningTable) / sizeof(uint8_t),
+                stateToIndex,
+                getNextStates,
+                [&](uint8_t depth, uint64_t idx, const SuperFastPhaseTwoCube& state) {
+                    out->lookup[idx] = depth;
+                },
+                &checkpoint
+        );
+    }
 }
 
 Database<PhaseOnePruningTable> PHASE_ONE_PRUNING_TABLE(
@@ -879,92 +737,27 @@ Database<PhaseTwoPruningTable> PHASE_TWO_PRUNING_TABLE(
         constructPhaseTwoPruningTable
 );
 
-FastRubiksCube genRandomCube() {
-    FastRubiksCube cube;
-
-    for (int i = 0; i < 100; i++) {
-        cube = cube.doMove(rand() % 18);
-    }
-
-    return cube;
-}
-
 void kociembaInit() {
-    for (int i = 0; i < 16; i++) {
-        std::set<int> possibleInverses;
-        for (int j = 0; j < 16; j++) possibleInverses.insert(j);
-
-        while (possibleInverses.size() > 1) {
-            FastRubiksCube orig = genRandomCube();
-            FastRubiksCube res = applySymmetry(orig, i);
-
-            std::set<int> newFrontier;
-            for (int j : possibleInverses) {
-                if (applySymmetry(res, j) == orig) {
-                    newFrontier.insert(j);
-                }
-            }
-
-            possibleInverses = newFrontier;
-        }
-
-        if (possibleInverses.size() != 1) {
-            std::cout << "Error: no inverse for symmetry " << i << std::endl;
-            exit(1);
-        }
-
-        REVERSE_SYMMETRIES[i] = *possibleInverses.begin();
-    }
-
-    for (int i = 0; i < 16; i++) {
-        for (int j = 0; j < 16; j++) {
-            std::set<int> possibleMult;
-
-            for (int k = 0; k < 16; k++) {
-                possibleMult.insert(k);
-            }
-
-            while (possibleMult.size() > 1) {
-                FastRubiksCube orig = genRandomCube();
-                FastRubiksCube res = applySymmetry(orig, i);
-                res = applySymmetry(res, j);
-
-                std::set<int> newFrontier;
-                for (int k : possibleMult) {
-                    if (applySymmetry(orig, k) == res) {
-                        newFrontier.insert(k);
-                    }
-                }
-
-                possibleMult = newFrontier;
-            }
-
-            if (possibleMult.size() != 1) {
-                std::cout << "Error: no mult for symmetries " << i << " and " << j << std::endl;
-                exit(1);
-            }
-
-            SYM_MULT[i][j] = *possibleMult.begin();
-        }
-    }
-
-    FLIP_UD_SLICE_SYM_COORDS.ensureLoaded();
-    CORNER_TWIST_MOVE_TABLE.ensureLoaded();
-    FLIP_UD_SLICE_SYM_MOVE_TABLE.ensureLoaded();
-    CORNER_TWIST_SYMMETRY_TABLE.ensureLoaded();
-    PHASE_ONE_PRUNING_TABLE.ensureLoaded();
-
-    CORNER_PERM_MOVE_TABLE.ensureLoaded();
-    CORNER_PERM_SYMMETRY_TABLE.ensureLoaded();
-    PHASE_2_EDGE_PERM_MOVE_TABLE.ensureLoaded();
-    PHASE_2_EDGE_PERM_SYMMETRY_TABLE.ensureLoaded();
-    PHASE_2_UD_SLICE_MOVE_TABLE.ensureLoaded();
-    PHASE_2_UD_SLICE_SYMMETRY_TABLE.ensureLoaded();
-
-    CORNER_PERM_SYM_COORDS.ensureLoaded();
-    CORNER_PERM_SYM_MOVE_TABLE.ensureLoaded();
-
-    PHASE_TWO_PRUNING_TABLE.ensureLoaded();
+    //The move and symmetry tables are small and needed to build the pruning tables, the pruning tables themselves are
+    //big so they load in the background. Solves wait for whatever they need in ensurePhaseOne/TwoTablesLoaded
+    FLIP_UD_SLICE_SYM_COORDS.preload();
+    CORNER_TWIST_MOVE_TABLE.preload();
+    FLIP_UD_SLICE_SYM_MOVE_TABLE.preload();
+    CORNER_TWIST_SYMMETRY_TABLE.preload();
+
+    CORNER_PERM_MOVE_TABLE.preload();
+    CORNER_PERM_SYMMETRY_TABLE.preload();
+    PHASE_2_EDGE_PERM_MOVE_TABLE.preload();
+    PHASE_2_EDGE_PERM_SYMMETRY_TABLE.preload();
+    PHASE_2_UD_SLICE_MOVE_TABLE.preload();
+    PHASE_2_UD_SLICE_SYMMETRY_TABLE.preload();
+
+    CORNER_PERM_SYM_COORDS.preload();
+    CORNER_PERM_SYM_MOVE_TABLE.preload();
+
+    //Phase two first, it's the only one a cube that is already in G1 needs
+    PHASE_TWO_PRUNING_TABLE.preload();
+    PHASE_ONE_PRUNING_TABLE.preload();
 
     return; // We don't need the tests
 
@@ -990,7 +783,7 @@ void kociembaInit() {
         }
     }
 
-    /*bool halt = false;
+    /*std::atomic<bool> halt = false;
     auto intoPhaseTwo = kociembaSolve(ref, halt);
     for (Move move : *intoPhaseTwo) {
         int idx = -1;
@@ -1086,14 +879,19 @@ void kociembaInit() {
             }
         }
     }
-
-    //collectData();
 }
 
-void solvePhaseOneAtDepth(SuperFastPhaseOneCube& cube, RedundantMovePreventor rmp, int depth, std::vector<int>& out, bool& halt, const std::function<void(std::vector<int>&)>& callback) {
-    uint8_t dist = PHASE_ONE_PRUNING_TABLE.ptr->lookup[cube.getPruningCoord()];
+//Nodes visited by this thread, so benchmarks can report nodes/s without the threads fighting over a shared counter
+static thread_local uint64_t nodeCount = 0;
+
+uint64_t getKociembaNodeCount() {
+    return nodeCount;
+}
 
+//dist is the pruning value of cube, the caller looks them up for all children at once so the cache misses overlap
+void solvePhaseOneAtDepth(SuperFastPhaseOneCube& cube, uint8_t dist, RedundantMovePreventor rmp, int depth, std::vector<int>& out, std::atomic<bool>& halt, const std::function<void(std::vector<int>&)>& callback) {
     if (halt) return;
+    nodeCount++;
 
     if (dist == 0) {
         if (cube.flipUDSlice / 16 == 0 && cube.cornerTwist == 0) {
@@ -1106,23 +904,40 @@ void solvePhaseOneAtDepth(SuperFastPhaseOneCube& cube, RedundantMovePreventor rm
         return;
     }
 
+    SuperFastPhaseOneCube children[18];
+    uint32_t childCoords[18];
+    uint8_t childDists[18];
+    int childMoves[18];
+    int numChildren = 0;
+
     for (int i = 0; i < 18; i++) {
         if (rmp.isRedundant(ALL_MOVES[i])) {
             continue;
         }
 
-        SuperFastPhaseOneCube next = cube.doMove(i);
+        children[numChildren] = cube.doMove(i);
+        childCoords[numChildren] = children[numChildren].getPruningCoord();
+        childMoves[numChildren] = i;
+        numChildren++;
+    }
+
+    CUBE_KERNELS.lookupBatch(PHASE_ONE_PRUNING_TABLE.ptr->lookup, sizeof(PhaseOnePruningTable), childCoords, childDists, numChildren);
+
+    for (int j = 0; j < numChildren; j++) {
+        int i = childMoves[j];
+
         RedundantMovePreventor nextRMP = rmp;
         nextRMP.turnFace(ALL_MOVES[i].side);
 
         out.push_back(i);
-        solvePhaseOneAtDepth(next, nextRMP, depth - 1, out, halt, callback);
+        solvePhaseOneAtDepth(children[j], childDists[j], nextRMP, depth - 1, out, halt, callback);
         out.pop_back();
     }
 }
 
-bool solvePhaseTwoAtDepth(SuperFastPhaseTwoCube& cube, RedundantMovePreventor rmp, int depth, std::vector<int>& out, bool& halt) {
+bool solvePhaseTwoAtDepth(SuperFastPhaseTwoCube& cube, RedundantMovePreventor rmp, int depth, std::vector<int>& out, std::atomic<bool>& halt) {
     uint8_t dist = PHASE_TWO_PRUNING_TABLE.ptr->lookup[cube.getPruningCoord()];
+    nodeCount++;
 
     if (halt) return true;
 
@@ -1154,7 +969,7 @@ bool solvePhaseTwoAtDepth(SuperFastPhaseTwoCube& cube, RedundantMovePreventor rm
     return false;
 }
 
-std::optional<std::vector<int>> solvePhaseTwo(SuperFastPhaseTwoCube& cube, bool& halt, int maxMoves = 18) {
+std::optional<std::vector<int>> solvePhaseTwo(SuperFastPhaseTwoCube& cube, std::atomic<bool>& halt, int maxMoves = 18) {
     int lowerBound = PHASE_TWO_PRUNING_TABLE.ptr->lookup[cube.getPruningCoord()];
     std::vector<int> out;
 
@@ -1170,13 +985,15 @@ std::optional<std::vector<int>> solvePhaseTwo(SuperFastPhaseTwoCube& cube, bool&
     return std::nullopt;
 }
 
-std::optional<std::vector<Move>> kociembaSolve(FastRubiksCube cube, bool& halt, std::function<void (std::string)> statusUpdateCallback) {
+static void ensurePhaseOneTablesLoaded() {
     FLIP_UD_SLICE_SYM_COORDS.ensureLoaded();
     CORNER_TWIST_MOVE_TABLE.ensureLoaded();
     FLIP_UD_SLICE_SYM_MOVE_TABLE.ensureLoaded();
     CORNER_TWIST_SYMMETRY_TABLE.ensureLoaded();
     PHASE_ONE_PRUNING_TABLE.ensureLoaded();
+}
 
+static void ensurePhaseTwoTablesLoaded() {
     CORNER_PERM_MOVE_TABLE.ensureLoaded();
     CORNER_PERM_SYMMETRY_TABLE.ensureLoaded();
     PHASE_2_EDGE_PERM_MOVE_TABLE.ensureLoaded();
@@ -1188,17 +1005,30 @@ std::optional<std::vector<Move>> kociembaSolve(FastRubiksCube cube, bool& halt,
     CORNER_PERM_SYM_MOVE_TABLE.ensureLoaded();
 
     PHASE_TWO_PRUNING_TABLE.ensureLoaded();
+}
+
+void ensureKociembaTablesLoaded() {
+    ensurePhaseOneTablesLoaded();
+    ensurePhaseTwoTablesLoaded();
+}
+
+//Oriented corners and edges with the UD slice edges in the slice, so phase two can solve it on its own
+static bool isInG1(const FastRubiksCube& cube) {
+    static const uint32_t SOLVED_FLIP_UD_SLICE = flipUDSliceCoordinate(FastRubiksCube());
+
+    return positionalCornerOrientationCoordinate(cube) == 0 && flipUDSliceCoordinate(cube) == SOLVED_FLIP_UD_SLICE;
+}
+
+void searchKociemba(const FastRubiksCube& cube, std::atomic<bool>& halt, int maxLength, const std::function<int (std::vector<int>&)>& onSolution) {
+    ensureKociembaTablesLoaded();
 
     SuperFastPhaseOneCube phaseOneCube(cube);
     int lowerBound = PHASE_ONE_PRUNING_TABLE.ptr->lookup[phaseOneCube.getPruningCoord()];
 
-    int bestTotalLength = 1000;
-    std::vector<int> bestMoves;
-
-    for (int numPhaseOneMoves = lowerBound; numPhaseOneMoves < bestTotalLength && !halt; numPhaseOneMoves++) {
+    for (int numPhaseOneMoves = lowerBound; numPhaseOneMoves <= maxLength && !halt; numPhaseOneMoves++) {
         //std::cout << "Trying to solve cube in " << numPhaseOneMoves << " moves!" << std::endl;
         std::vector<int> phaseOneMoves;
-        solvePhaseOneAtDepth(phaseOneCube, RedundantMovePreventor(), numPhaseOneMoves, phaseOneMoves, halt, [&](std::vector<int>& moves) {
+        solvePhaseOneAtDepth(phaseOneCube, lowerBound, RedundantMovePreventor(), numPhaseOneMoves, phaseOneMoves, halt, [&](std::vector<int>& moves) {
 
             FastRubiksCube copy = cube;
             for (int move: moves) {
@@ -1207,145 +1037,173 @@ std::optional<std::vector<Move>> kociembaSolve(FastRubiksCube cube, bool& halt,
 
             SuperFastPhaseTwoCube phaseTwoCube(copy);
 
-            std::optional<std::vector<int>> phaseTwoMoves = solvePhaseTwo(phaseTwoCube, halt, bestTotalLength - numPhaseOneMoves - 1);
+            std::optional<std::vector<int>> phaseTwoMoves = solvePhaseTwo(phaseTwoCube, halt, maxLength - (int) moves.size());
 
-            if (phaseTwoMoves) {
-                bestMoves = moves;
-                //std::cout << "Found phase two solution with " << phaseTwoMoves->size() << " moves!" << std::endl;
-                bestMoves.insert(bestMoves.end(), phaseTwoMoves->begin(), phaseTwoMoves->end());
-                bestTotalLength = numPhaseOneMoves + phaseTwoMoves->size();
-                //std::cout << "Best total length is now " << bestTotalLength << std::endl;
-                statusUpdateCallback("Found " + std::to_string(bestTotalLength) + " move solution");
+            //A halted phase two search hands back whatever path it was on
+            if (!phaseTwoMoves || halt) {
+                return;
             }
-        });
-    }
 
-    if (bestMoves.empty()) {
-        return std::nullopt;
-    }
+            std::vector<int> solution = moves;
+            //std::cout << "Found phase two solution with " << phaseTwoMoves->size() << " moves!" << std::endl;
+            solution.insert(solution.end(), phaseTwoMoves->begin(), phaseTwoMoves->end());
 
-    std::vector<Move> out;
-    for (int move: bestMoves) {
-        out.push_back(ALL_MOVES[move]);
+            maxLength = onSolution(solution);
+        });
     }
+}
 
-    std::cout << "Final solution has " << out.size() << " moves!" << std::endl;
+std::optional<std::vector<Move>> kociembaSolve(FastRubiksCube cube, std::atomic<bool>& halt, std::function<void (std::string)> statusUpdateCallback, const MoveCostModel* costModel) {
+    //While the phase one table is still loading a cube in G1 gets a phase two only solution instead of waiting. That
+    //can be a few moves longer than the full search would find, but it's still at most 18 moves. Phase two only finds
+    //one solution, so there is nothing for costModel to choose between
+    if (!PHASE_ONE_PRUNING_TABLE.isLoaded() && isInG1(cube)) {
+        if (!PHASE_TWO_PRUNING_TABLE.isLoaded()) {
+            statusUpdateCallback("Waiting for phase two tables");
+        }
+        ensurePhaseTwoTablesLoaded();
 
-    return out;
-}
+        SuperFastPhaseTwoCube phaseTwoCube(cube);
+        std::optional<std::vector<int>> phaseTwoMoves = solvePhaseTwo(phaseTwoCube, halt);
 
-void collectData() {
-    /*std::ifstream in("kociemba.csv");
+        //A halted phase two search hands back whatever path it was on
+        if (!phaseTwoMoves || halt) {
+            return std::nullopt;
+        }
 
-    if (!in) {
-        std::ofstream out("kociemba.csv");
-        out << "Num Moves,Solve" << std::endl;
+        std::vector<Move> out;
+        for (int move: *phaseTwoMoves) {
+            out.push_back(ALL_MOVES[move]);
+        }
 
-        out.close();
+        return out;
     }
 
-    in.close();
+    if (!PHASE_ONE_PRUNING_TABLE.isLoaded() || !PHASE_TWO_PRUNING_TABLE.isLoaded()) {
+        statusUpdateCallback("Waiting for tables");
+    }
+    ensurePhaseOneTablesLoaded();
+    ensurePhaseTwoTablesLoaded();
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 17);
+    int bestTotalLength = 1000;
+    std::vector<int> bestMoves;
 
-    //Open kociemba.csv to append to it
-    while (true) {
-        FastRubiksCube cube;
+    //With a cost model, solutions up to KOCIEMBA_COST_SLACK moves longer than the best one are also ranked by cost.
+    //cheapest[i] is the cheapest one found that is i moves longer than the best, ranked as found. Only these few
+    //finalists get optimized
+    struct CostedSolution {
+        double cost = std::numeric_limits<double>::infinity();
+        std::vector<int> moves;
+    };
+    std::array<CostedSolution, KOCIEMBA_COST_SLACK + 1> cheapest;
+
+    searchKociemba(cube, halt, bestTotalLength - 1, [&](std::vector<int>& solution) {
+        int length = solution.size();
+
+        if (length < bestTotalLength) {
+            if (costModel) {
+                //Everything is now further from the best length
+                int shift = std::min(bestTotalLength - length, KOCIEMBA_COST_SLACK + 1);
+                std::move_backward(cheapest.begin(), cheapest.end() - shift, cheapest.end());
+                std::fill(cheapest.begin(), cheapest.begin() + shift, CostedSolution());
+            }
 
-        for (int i = 0; i < 10000; i++) {
-            int move = dis(gen);
-            cube = cube.doMove(move);
+            bestMoves = solution;
+            bestTotalLength = length;
+            //std::cout << "Best total length is now " << bestTotalLength << std::endl;
+            statusUpdateCallback("Found " + std::to_string(bestTotalLength) + " move solution");
         }
 
-        //Launch kociembaSolve in a separate thread
-        bool halt = false;
-        std::thread t([&]() {
-            auto solution = kociembaSolve(cube, halt);
+        if (!costModel) {
+            return bestTotalLength - 1;
+        }
 
-            //Open kociemba.csv to append to it
-            std::ofstream out("kociemba.csv", std::ios::app);
+        double cost = costModel->getCost(solution);
+        CostedSolution& slot = cheapest[length - bestTotalLength];
+        if (cost < slot.cost) {
+            slot = {cost, solution};
+        }
 
-            if (solution) {
-                out << solution->size() << ",";
+        return bestTotalLength + KOCIEMBA_COST_SLACK;
+    });
 
-                for (Move move: *solution) {
-                    out << move.moveCode() << " ";
-                }
+    if (bestMoves.empty()) {
+        return std::nullopt;
+    }
 
-                out << std::endl;
-            } else {
-                out << "," << std::endl;
-            }
+    if (costModel) {
+        //Ranked the way it will actually be executed
+        double bestCost = std::numeric_limits<double>::infinity();
 
-            out.close();
+        for (const CostedSolution& finalist: cheapest) {
+            if (finalist.cost == std::numeric_limits<double>::infinity()) continue;
 
-            std::cout << "Solved random cube in " << solution->size() << " moves!" << std::endl;
-        });
+            std::vector<int> optimized = optimizeSolution(finalist.moves);
+            double cost = costModel->getCost(optimized);
 
-        //Wait for 15 seconds
-        std::this_thread::sleep_for(std::chrono::seconds(15));
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestMoves = optimized;
+            }
+        }
+    }
 
-        halt = true;
+    std::vector<Move> out;
+    for (int move: bestMoves) {
+        out.push_back(ALL_MOVES[move]);
+    }
 
-        t.join();
-    }*/
+    std::cout << "Final solution has " << out.size() << " moves!" << std::endl;
 
-    const int NUM_SOLVES = 100;
-    auto allowed_duration = std::chrono::milliseconds(10);
+    return out;
+}
 
-    std::vector<FastRubiksCube> cubes;
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 17);
+std::vector<std::vector<Move>> kociembaSolveTopK(FastRubiksCube cube, std::atomic<bool>& halt, int maxSolutions, int maxLength, std::function<void (std::string)> statusUpdateCallback) {
+    if (!PHASE_ONE_PRUNING_TABLE.isLoaded() || !PHASE_TWO_PRUNING_TABLE.isLoaded()) {
+        statusUpdateCallback("Waiting for tables");
+    }
+    ensurePhaseOneTablesLoaded();
+    ensurePhaseTwoTablesLoaded();
 
-    for (int i = 0; i < NUM_SOLVES; i++) {
-        FastRubiksCube cube;
+    auto shorterFirst = [](const std::vector<int>& a, const std::vector<int>& b) {
+        if (a.size() != b.size()) return a.size() < b.size();
+        return a < b;
+    };
 
-        for (int j = 0; j < 100000; j++) {
-            int move = dis(gen);
-            cube = cube.doMove(move);
-        }
+    //Simplified solutions, which puts commuting turns in a fixed order so reorderings of one solution collide. Never
+    //holds more than maxSolutions of them
+    std::set<std::vector<int>, decltype(shorterFirst)> solutions(shorterFirst);
 
-        cubes.push_back(cube);
-    }
+    if (maxSolutions > 0) {
+        searchKociemba(cube, halt, maxLength, [&](std::vector<int>& solution) {
+            std::vector<int> simplified = simplifyMoves(solution);
 
-    std::cout << "Finished generating " << NUM_SOLVES << " random cubes!" << std::endl;
-    std::vector<int> numMoves;
-
-    for (int i = 0; i < NUM_SOLVES; i++) {
-        bool halt = false;
-        auto start = std::chrono::high_resolution_clock::now();
-        std::thread t([&]() {
-            auto sol = kociembaSolve(cubes[i], halt, [](std::string message){});
-            if (sol) {
-                numMoves.push_back(sol->size());
-            } else {
-                numMoves.push_back(-1);
-            }
-        });
+            if (solutions.insert(simplified).second) {
+                if ((int) solutions.size() > maxSolutions) {
+                    solutions.erase(std::prev(solutions.end()));
+                }
 
-        std::this_thread::sleep_for(allowed_duration);
+                statusUpdateCallback("Found " + std::to_string(solutions.size()) + " solutions");
+            }
 
-        halt = true;
-        t.join();
+            //Once full, only strictly shorter solutions can get in
+            if ((int) solutions.size() == maxSolutions) {
+                return std::min(maxLength, (int) solutions.rbegin()->size() - 1);
+            }
 
-        std::cout << "Solved cube " << i << " in " << numMoves.back() << " moves!" << std::endl;
+            return maxLength;
+        });
     }
 
-    std::vector<int> histogram(50);
-
-    for (int numMove: numMoves) {
-        if (numMove != -1) {
-            histogram[numMove]++;
-        } else {
-            std::cout << "Failed to solve cube!" << std::endl;
+    std::vector<std::vector<Move>> out;
+    for (const std::vector<int>& solution: solutions) {
+        std::vector<Move> moves;
+        for (int move: solution) {
+            moves.push_back(ALL_MOVES[move]);
         }
-    }
 
-    for (int i = 0; i < histogram.size(); i++) {
-        if (histogram[i])
-            std::cout << i << ": " << histogram[i] << std::endl;
+        out.push_back(moves);
     }
-}
\ No newline at end of file
+
+    return out;
+}
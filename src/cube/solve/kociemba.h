@@ -7,10 +7,16 @@
 
 #include <cstdint>
 #include <optional>
+#include <atomic>
+#include <functional>
+#include <string>
 
 #include "cube/FastRubiksCube.h"
+#include "move_cost.h"
 
 void kociembaInit();
+//Blocks until every table the search needs is loaded, kociembaInit only starts loading the big ones
+void ensureKociembaTablesLoaded();
 
 uint32_t cornerOrientationCoordinate(const FastRubiksCube& cube);
 uint32_t edgeOrientationCoordinate(const FastRubiksCube& cube);
@@ -21,8 +27,25 @@ uint32_t phase2EdgePermutationCoordinate(const FastRubiksCube& cube);
 
 FastRubiksCube reduceTest(const FastRubiksCube& cube);
 
-std::optional<std::vector<Move>> kociembaSolve(FastRubiksCube cube, bool& halt, std::function<void (std::string)> statusUpdateCallback);
+//Extra moves over the shortest solution found that a cost model may trade for a cheaper solution
+const int KOCIEMBA_COST_SLACK = 2;
 
-void collectData();
+//Without a cost model this returns the shortest solution found, with one the cheapest that is at most
+//KOCIEMBA_COST_SLACK moves longer. A cube in G1 solved before the phase one table has loaded gets the phase two
+//solution whatever the cost model says
+std::optional<std::vector<Move>> kociembaSolve(FastRubiksCube cube, std::atomic<bool>& halt, std::function<void (std::string)> statusUpdateCallback, const MoveCostModel* costModel = nullptr);
+
+//The best maxSolutions distinct solutions of at most maxLength moves, shortest first. Solutions that only differ in the
+//order of commuting turns (like U D and D U) count as one. Runs until the search is exhausted or halt is set
+std::vector<std::vector<Move>> kociembaSolveTopK(FastRubiksCube cube, std::atomic<bool>& halt, int maxSolutions, int maxLength, std::function<void (std::string)> statusUpdateCallback);
+
+/*
+ * The two phase search behind kociembaSolve and kociembaSolveTopK. Every solution found is handed to onSolution, which
+ * returns the longest solution still worth finding. Stops once phase one alone needs more moves than that, or on halt
+ */
+void searchKociemba(const FastRubiksCube& cube, std::atomic<bool>& halt, int maxLength, const std::function<int (std::vector<int>&)>& onSolution);
+
+//Phase one and two search nodes visited so far by the calling thread
+uint64_t getKociembaNodeCount();
 
 #endif //RUBIK_KOCIEMBA_H
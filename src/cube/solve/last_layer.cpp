@@ -0,0 +1,215 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#include "last_layer.h"
+#include "database.h"
+#include "symmetry.h"
+#include "cube/PermutationRanking.h"
+
+#include <queue>
+#include <sstream>
+
+struct LastLayerEntry {
+    //The case this one turns into after algorithm
+    uint32_t next;
+    //Moves left until solved, UINT16_MAX if the case can't be reached
+    uint16_t cost;
+    uint8_t algorithm;
+};
+
+//Written with the last layer on top like they usually are, flipped onto the bottom by parseAlgorithm
+static const char* const LAST_LAYER_ALGORITHMS[] = {
+        "U", "U2", "U'",
+        "R U R' U R U2 R'",                                 //Sune
+        "R U2 R' U' R U' R'",                               //Antisune
+        "R U R' U R U' R' U R U2 R'",                       //Double sune
+        "F R U R' U' F'",
+        "F U R U' R' F'",
+        "R U R' U' R' F R2 U' R' U' R U R' F'",             //T perm
+        "R U' R U R U R U' R' U' R2",                       //Ua perm
+        "R2 U R U R' U' R' U' R' U R'",                     //Ub perm
+        "R U R' F' R U R' U' R' F R2 U' R'",                //Jb perm
+        "F R U' R' U' R U R' F' R U R' U' R' F R F'",       //Y perm
+};
+
+const int NUM_LAST_LAYER_ALGORITHMS = sizeof(LAST_LAYER_ALGORITHMS) / sizeof(LAST_LAYER_ALGORITHMS[0]);
+
+//Turning the whole cube upside down around the L-R axis swaps U with D and F with B, the turn directions stay the same
+static const Side FLIP_UPSIDE_DOWN[6] = {BACK, FRONT, LEFT, RIGHT, BOTTOM, TOP};
+
+static std::vector<int> parseAlgorithm(const std::string& algorithm) {
+    std::vector<int> moves;
+    std::istringstream in(algorithm);
+    std::string token;
+
+    while (in >> token) {
+        Move move = Move::fromString(token);
+        moves.push_back((move.moveType - 1) * 6 + FLIP_UPSIDE_DOWN[move.side]);
+    }
+
+    return moves;
+}
+
+static std::array<Corner, 4> TOP_CORNERS = {TOP_LEFT_FRONT, TOP_RIGHT_FRONT, TOP_RIGHT_BACK, TOP_LEFT_BACK};
+static std::array<Edge, 8> FIRST_TWO_LAYER_EDGES = {TOP_FRONT, TOP_RIGHT, TOP_BACK, TOP_LEFT, FRONT_RIGHT, BACK_RIGHT, BACK_LEFT, FRONT_LEFT};
+
+bool isFirstTwoLayersSolved(const FastRubiksCube& cube) {
+    return cube.isPartiallySolved(TOP_CORNERS) && cube.isPartiallySolved(FIRST_TWO_LAYER_EDGES);
+}
+
+uint32_t getLastLayerIndex(const FastRubiksCube& cube) {
+    uint8_t corners[4];
+    uint8_t edges[4];
+
+    for (int i = 0; i < 4; i++) {
+        corners[i] = cube.corners[BOTTOM_LEFT_FRONT + i] - BOTTOM_LEFT_FRONT;
+        edges[i] = cube.edges[BOTTOM_FRONT + i] - BOTTOM_FRONT;
+    }
+
+    //The last orientation of each follows from the others
+    uint32_t twist = 0;
+    uint32_t flip = 0;
+    for (int i = 0; i < 3; i++) {
+        twist = twist * 3 + cube.cornerOrientations[BOTTOM_LEFT_FRONT + i];
+        flip = flip * 2 + cube.edgeOrientations[BOTTOM_FRONT + i];
+    }
+
+    return ((rankPermutation(corners, 4, 4) * 27 + twist) * 24 + rankPermutation(edges, 4, 4)) * 8 + flip;
+}
+
+FastRubiksCube fromLastLayerIndex(uint32_t index) {
+    FastRubiksCube cube;
+
+    uint32_t flip = index % 8;
+    index /= 8;
+    uint32_t edgePerm = index % 24;
+    index /= 24;
+    uint32_t twist = index % 27;
+    uint32_t cornerPerm = index / 27;
+
+    uint8_t corners[4];
+    uint8_t edges[4];
+    unrankPermutation(cornerPerm, corners, 4, 4);
+    unrankPermutation(edgePerm, edges, 4, 4);
+
+    int twistSum = 0;
+    int flipSum = 0;
+    for (int i = 3; i >= 0; i--) {
+        cube.corners[BOTTOM_LEFT_FRONT + i] = corners[i] + BOTTOM_LEFT_FRONT;
+        cube.edges[BOTTOM_FRONT + i] = edges[i] + BOTTOM_FRONT;
+
+        if (i < 3) {
+            cube.cornerOrientations[BOTTOM_LEFT_FRONT + i] = twist % 3;
+            cube.edgeOrientations[BOTTOM_FRONT + i] = flip % 2;
+            twistSum += twist % 3;
+            flipSum += flip % 2;
+            twist /= 3;
+            flip /= 2;
+        }
+    }
+
+    cube.cornerOrientations[BOTTOM_LEFT_BACK] = (3 - twistSum % 3) % 3;
+    cube.edgeOrientations[BOTTOM_LEFT] = flipSum % 2;
+
+    return cube;
+}
+
+static std::vector<std::vector<int>> getAlgorithms() {
+    std::vector<std::vector<int>> algorithms;
+
+    for (const char* algorithm: LAST_LAYER_ALGORITHMS) {
+        algorithms.push_back(parseAlgorithm(algorithm));
+    }
+
+    return algorithms;
+}
+
+//Dijkstra backwards from the solved case, running every algorithm in reverse
+static void constructLastLayerTable(LastLayerEntry* out) {
+    auto algorithms = getAlgorithms();
+
+    for (int i = 0; i < NUM_LAST_LAYER_ALGORITHMS; i++) {
+        FastRubiksCube cube;
+        for (int move: algorithms[i]) {
+            cube = cube.doMove(move);
+        }
+
+        if (!isFirstTwoLayersSolved(cube)) {
+            std::cerr << "Last layer algorithm " << LAST_LAYER_ALGORITHMS[i] << " breaks the first two layers" << std::endl;
+            exit(1);
+        }
+    }
+
+    for (uint32_t i = 0; i < NUM_LAST_LAYER_INDICES; i++) {
+        out[i] = {0, UINT16_MAX, 0};
+    }
+
+    typedef std::pair<uint16_t, uint32_t> QueueEntry;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<>> queue;
+
+    uint32_t solved = getLastLayerIndex(FastRubiksCube());
+    out[solved].cost = 0;
+    queue.push({0, solved});
+
+    uint32_t reached = 0;
+
+    while (!queue.empty()) {
+        auto [cost, index] = queue.top();
+        queue.pop();
+
+        if (cost != out[index].cost) continue;
+        reached++;
+
+        FastRubiksCube cube = fromLastLayerIndex(index);
+
+        for (int i = 0; i < NUM_LAST_LAYER_ALGORITHMS; i++) {
+            FastRubiksCube prev = cube;
+            for (auto it = algorithms[i].rbegin(); it != algorithms[i].rend(); it++) {
+                prev = prev.doMove(inverseMove(*it));
+            }
+
+            uint32_t prevIndex = getLastLayerIndex(prev);
+            uint16_t prevCost = cost + algorithms[i].size();
+
+            if (prevCost < out[prevIndex].cost) {
+                out[prevIndex] = {index, prevCost, (uint8_t) i};
+                queue.push({prevCost, prevIndex});
+            }
+        }
+    }
+
+    std::cout << "Reached " << reached << " last layer cases" << std::endl;
+}
+
+Database<LastLayerEntry> LAST_LAYER_TABLE(
+        sizeof(LastLayerEntry) * NUM_LAST_LAYER_INDICES,
+        "data/last_layer.bin",
+        [](LastLayerEntry* out) {
+            constructLastLayerTable(out);
+        }
+);
+
+std::optional<std::vector<int>> solveLastLayer(const FastRubiksCube& cube) {
+    if (!isFirstTwoLayersSolved(cube)) {
+        return std::nullopt;
+    }
+
+    LAST_LAYER_TABLE.ensureLoaded();
+    static const std::vector<std::vector<int>> algorithms = getAlgorithms();
+
+    std::vector<int> moves;
+    uint32_t index = getLastLayerIndex(cube);
+
+    if (LAST_LAYER_TABLE.ptr[index].cost == UINT16_MAX) {
+        return std::nullopt;
+    }
+
+    while (LAST_LAYER_TABLE.ptr[index].cost != 0) {
+        const LastLayerEntry& entry = LAST_LAYER_TABLE.ptr[index];
+        moves.insert(moves.end(), algorithms[entry.algorithm].begin(), algorithms[entry.algorithm].end());
+        index = entry.next;
+    }
+
+    return moves;
+}
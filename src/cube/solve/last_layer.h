@@ -0,0 +1,36 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_LAST_LAYER_H
+#define RUBIK_LAST_LAYER_H
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "cube/FastRubiksCube.h"
+
+/*
+ * Last layer lookup for the CFOP solver.
+ *
+ * The CFOP solver builds the cross and the first two layers on the top face, so the last layer is the bottom one. Once
+ * everything else is solved a cube is fully described by where its four bottom corners and edges are and how they are
+ * turned, which is small enough to give every case its own table entry.
+ *
+ * The table is built from a short list of OLL/PLL algorithms plus the D turns (the AUF). Every entry holds the
+ * algorithm that moves it closest to solved and the case it leads to, so a solution is a chain of algorithms the way a
+ * person would do it rather than an optimal move sequence.
+ */
+
+const uint32_t NUM_LAST_LAYER_INDICES = 24 * 27 * 24 * 8;
+
+//Only meaningful if everything outside the bottom layer is solved
+uint32_t getLastLayerIndex(const FastRubiksCube& cube);
+FastRubiksCube fromLastLayerIndex(uint32_t index);
+
+bool isFirstTwoLayersSolved(const FastRubiksCube& cube);
+
+//Moves that solve the last layer, or nothing if the first two layers aren't solved
+std::optional<std::vector<int>> solveLastLayer(const FastRubiksCube& cube);
+
+#endif //RUBIK_LAST_LAYER_H
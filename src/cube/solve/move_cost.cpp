@@ -0,0 +1,46 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#include "move_cost.h"
+
+#include <cstddef>
+
+double RobotCostModel::getCost(const std::vector<int>& moves) const {
+    double cost = 0;
+    int freeAxis = startFreeAxis;
+
+    for (std::size_t i = 0; i < moves.size(); i++) {
+        int side = moves[i] % 6;
+        int axis = side / 2;
+
+        if (axis == freeAxis) {
+            cost += regripTime;
+
+            //Let go of whichever of the other two axes is needed last
+            int a = (axis + 1) % 3;
+            int b = (axis + 2) % 3;
+            freeAxis = b;
+
+            for (std::size_t j = i + 1; j < moves.size(); j++) {
+                int nextAxis = moves[j] % 6 / 2;
+
+                if (nextAxis == a) {
+                    freeAxis = b;
+                    break;
+                } else if (nextAxis == b) {
+                    freeAxis = a;
+                    break;
+                }
+            }
+        }
+
+        if (i > 0 && moves[i - 1] % 6 != side) {
+            cost += faceChangeTime;
+        }
+
+        cost += moves[i] / 6 == 1 ? halfTurnTime : quarterTurnTime;
+    }
+
+    return cost;
+}
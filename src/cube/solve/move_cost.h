@@ -0,0 +1,48 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_MOVE_COST_H
+#define RUBIK_MOVE_COST_H
+
+#include <vector>
+
+/*
+ * How expensive a move sequence is to execute. The solvers minimise the number of moves, a cost model lets the caller
+ * pick between solutions of similar length by what actually matters to them, like the time the robot needs.
+ */
+class MoveCostModel {
+public:
+    virtual ~MoveCostModel() = default;
+
+    virtual double getCost(const std::vector<int>& moves) const = 0;
+};
+
+//Every move costs the same, the metric the solvers already use
+class MoveCountCostModel : public MoveCostModel {
+public:
+    double getCost(const std::vector<int>& moves) const override {
+        return (double) moves.size();
+    }
+};
+
+/*
+ * Estimated seconds on a robot with four grippers. Two axes are held at any time, turning a face on the third one
+ * needs a regrip that rotates the cube and frees up one of the held axes. The default timings are rough estimates and
+ * should be measured on the actual robot.
+ */
+class RobotCostModel : public MoveCostModel {
+public:
+    double quarterTurnTime = 0.12;
+    double halfTurnTime = 0.2;
+    //Added whenever the next move turns a different face
+    double faceChangeTime = 0.05;
+    double regripTime = 0.6;
+
+    //Axis the robot can't turn before the first regrip, axis = side / 2
+    int startFreeAxis = 2;
+
+    double getCost(const std::vector<int>& moves) const override;
+};
+
+#endif //RUBIK_MOVE_COST_H
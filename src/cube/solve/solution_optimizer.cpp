@@ -0,0 +1,177 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#include "solution_optimizer.h"
+#include "util/RedundantMovePreventor.h"
+
+#include <algorithm>
+#include <array>
+
+int moveIndex(const Move& move) {
+    return (move.moveType - 1) * 6 + move.side;
+}
+
+//Clockwise quarter turns done by a move, 1 to 3
+static int quarterTurns(int move) {
+    return move / 6 + 1;
+}
+
+static int axisOf(int side) {
+    return side / 2;
+}
+
+std::vector<int> simplifyMoves(const std::vector<int>& moves) {
+    //Quarter turns of both faces of an axis, for every run of turns on the same axis
+    struct AxisGroup {
+        int axis;
+        std::array<int, 2> turns;
+    };
+
+    std::vector<AxisGroup> groups;
+
+    for (int move: moves) {
+        int side = move % 6;
+
+        if (groups.empty() || groups.back().axis != axisOf(side)) {
+            groups.push_back({axisOf(side), {0, 0}});
+        }
+
+        AxisGroup& group = groups.back();
+        group.turns[side % 2] = (group.turns[side % 2] + quarterTurns(move)) % 4;
+
+        //Whatever came before can now merge with whatever comes next
+        if (group.turns[0] == 0 && group.turns[1] == 0) {
+            groups.pop_back();
+        }
+    }
+
+    std::vector<int> res;
+    for (const AxisGroup& group: groups) {
+        for (int i = 0; i < 2; i++) {
+            if (group.turns[i] != 0) {
+                res.push_back((group.turns[i] - 1) * 6 + group.axis * 2 + i);
+            }
+        }
+    }
+
+    return res;
+}
+
+struct WindowEntry {
+    uint64_t edgeIndex;
+    uint32_t cornerIndex;
+    //Up to OPTIMIZER_TABLE_DEPTH moves, five bits each, the first one in the lowest bits
+    uint32_t moves;
+    uint8_t length;
+
+    bool operator<(const WindowEntry& other) const {
+        if (edgeIndex != other.edgeIndex) return edgeIndex < other.edgeIndex;
+        if (cornerIndex != other.cornerIndex) return cornerIndex < other.cornerIndex;
+        return length < other.length;
+    }
+};
+
+static void enumerateWindows(const FastRubiksCube& cube, RedundantMovePreventor rmp, int depth, uint32_t moves, uint8_t length, std::vector<WindowEntry>& out) {
+    out.push_back({cube.getEdgeIndex(), cube.getCornerIndex(), moves, length});
+
+    if (depth == 0) return;
+
+    for (int i = 0; i < 18; i++) {
+        if (rmp.isRedundant(ALL_MOVES[i])) continue;
+
+        RedundantMovePreventor nextRMP = rmp;
+        nextRMP.turnFace(ALL_MOVES[i].side);
+
+        enumerateWindows(cube.doMove(i), nextRMP, depth - 1, moves | (i << (5 * length)), length + 1, out);
+    }
+}
+
+//Every cube within OPTIMIZER_TABLE_DEPTH moves, with its shortest sequence. About 620k entries, built on first use
+static const std::vector<WindowEntry>& getWindowTable() {
+    static const std::vector<WindowEntry> table = []() {
+        std::vector<WindowEntry> entries;
+        enumerateWindows(FastRubiksCube(), RedundantMovePreventor(), OPTIMIZER_TABLE_DEPTH, 0, 0, entries);
+
+        //Shortest first within each cube, then keep only that one
+        std::sort(entries.begin(), entries.end());
+        entries.erase(std::unique(entries.begin(), entries.end(), [](const WindowEntry& a, const WindowEntry& b) {
+            return a.edgeIndex == b.edgeIndex && a.cornerIndex == b.cornerIndex;
+        }), entries.end());
+
+        return entries;
+    }();
+
+    return table;
+}
+
+static const WindowEntry* findWindow(const FastRubiksCube& cube) {
+    const std::vector<WindowEntry>& table = getWindowTable();
+
+    WindowEntry key = {cube.getEdgeIndex(), cube.getCornerIndex(), 0, 0};
+    auto it = std::lower_bound(table.begin(), table.end(), key);
+
+    if (it == table.end() || it->edgeIndex != key.edgeIndex || it->cornerIndex != key.cornerIndex) {
+        return nullptr;
+    }
+
+    return &*it;
+}
+
+//Replaces the first stretch of moves that has a shorter equivalent, returns false if there is none
+static bool resolveWindow(std::vector<int>& moves) {
+    for (size_t start = 0; start < moves.size(); start++) {
+        size_t maxLength = std::min((size_t) OPTIMIZER_MAX_WINDOW, moves.size() - start);
+
+        FastRubiksCube cube;
+        std::vector<FastRubiksCube> prefixes;
+        for (size_t i = 0; i < maxLength; i++) {
+            cube = cube.doMove(moves[start + i]);
+            prefixes.push_back(cube);
+        }
+
+        //Longest first, it has the most to gain
+        for (size_t length = maxLength; length >= 2; length--) {
+            const WindowEntry* entry = findWindow(prefixes[length - 1]);
+
+            if (entry && entry->length < length) {
+                std::vector<int> replacement;
+                for (int i = 0; i < entry->length; i++) {
+                    replacement.push_back((entry->moves >> (5 * i)) & 31);
+                }
+
+                moves.erase(moves.begin() + start, moves.begin() + start + length);
+                moves.insert(moves.begin() + start, replacement.begin(), replacement.end());
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+std::vector<int> optimizeSolution(const std::vector<int>& moves, bool resolveWindows) {
+    std::vector<int> res = simplifyMoves(moves);
+
+    if (resolveWindows) {
+        while (resolveWindow(res)) {
+            res = simplifyMoves(res);
+        }
+    }
+
+    return res;
+}
+
+std::vector<Move> optimizeSolution(const std::vector<Move>& moves, bool resolveWindows) {
+    std::vector<int> indices;
+    for (const Move& move: moves) {
+        indices.push_back(moveIndex(move));
+    }
+
+    std::vector<Move> res;
+    for (int move: optimizeSolution(indices, resolveWindows)) {
+        res.push_back(ALL_MOVES[move]);
+    }
+
+    return res;
+}
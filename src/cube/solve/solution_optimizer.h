@@ -0,0 +1,33 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_SOLUTION_OPTIMIZER_H
+#define RUBIK_SOLUTION_OPTIMIZER_H
+
+#include <vector>
+#include "cube/FastRubiksCube.h"
+
+/*
+ * Shortens finished solutions before they are shown or sent to the robot.
+ *
+ * Solvers that glue several searches together (phase one and two of Kociemba, the CFOP stages) leave moves at the
+ * seams that cancel or merge, like U U' or R L R. simplifyMoves cleans those up. optimizeSolution also replaces short
+ * stretches of the solution with the shortest sequence that does the same thing, using a table of every cube at most
+ * OPTIMIZER_TABLE_DEPTH moves from solved.
+ */
+
+const int OPTIMIZER_TABLE_DEPTH = 5;
+//Longest stretch of moves optimizeSolution tries to replace
+const int OPTIMIZER_MAX_WINDOW = 12;
+
+int moveIndex(const Move& move);
+
+//Merges turns of the same face and drops the ones that cancel, looking through turns of the opposite face since those
+//commute. Turns on one axis always come out in Side order
+std::vector<int> simplifyMoves(const std::vector<int>& moves);
+
+std::vector<int> optimizeSolution(const std::vector<int>& moves, bool resolveWindows = true);
+std::vector<Move> optimizeSolution(const std::vector<Move>& moves, bool resolveWindows = true);
+
+#endif //RUBIK_SOLUTION_OPTIMIZER_H
@@ -9,10 +9,16 @@
 #include <vector>
 #include <functional>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include "util/RedundantMovePreventor.h"
 #include "database.h"
 #include "kociemba.h"
 #include "solver_util.h"
+#include "symmetry.h"
+#include "last_layer.h"
+#include "solution_optimizer.h"
 
 constexpr uint64_t fact(uint64_t n) noexcept {
     return n == 0 ? 1 : n * fact(n - 1);
@@ -38,7 +44,7 @@ constexpr uint64_t bpow(uint64_t base, uint64_t exp) noexcept {
 
 
 template<typename KeyGetter>
-void genDataDisk(KeyGetter keyGetter, const std::function<void(uint64_t, uint8_t)>& setter, uint64_t size) {
+void genDataDisk(KeyGetter keyGetter, const std::function<void(uint64_t, uint8_t)>& setter, uint64_t size, TableCheckpoint* checkpoint = nullptr) {
     auto startTime = std::chrono::high_resolution_clock::now();
 
     struct CachedCube {
@@ -49,33 +55,44 @@ void genDataDisk(KeyGetter keyGetter, const std::function<void(uint64_t, uint8_t
         CachedCube(FastRubiksCube cube, uint64_t idx) : cube(cube), idx(idx) {}
     };
 
+    auto frontierFile = [&](int frontierDepth) {
+        if (checkpoint) {
+            return checkpoint->getFilePath("frontier", frontierDepth);
+        }
+        return "data/tmp/frontier-" + std::to_string(frontierDepth) + ".bin";
+    };
+
     bool* queued = new bool[size];
     memset(queued, 0, size);
 
     int depth = 0;
-    std::string frontierPath = "data/tmp/frontier-0.bin";
-
-    std::filesystem::path frontierPathObject = frontierPath;
-    std::filesystem::create_directories(frontierPathObject.parent_path());
+    std::string frontierPath;
+    uint64_t frontierSize = 1;
+    uint64_t processed = 0;
+
+    if (checkpoint && checkpoint->hasSavedState()) {
+        depth = checkpoint->getDepth();
+        frontierPath = frontierFile(depth);
+        frontierSize = checkpoint->getFrontierSize();
+        processed = checkpoint->getProcessed();
+        TableCheckpoint::readFile(checkpoint->getFilePath("queued", depth), queued, size);
+    } else {
+        frontierPath = frontierFile(0);
 
-    std::ofstream frontierOut(frontierPath, std::ios::binary);
-    FastRubiksCube startCube;
-    CachedCube start(startCube, keyGetter(startCube));
-    frontierOut.write((char*) &start, sizeof(CachedCube));
-    frontierOut.close();
-    queued[start.idx] = true;
-    int frontierSize = 1;
+        FastRubiksCube startCube;
+        CachedCube start(startCube, keyGetter(startCube));
+        TableCheckpoint::writeFile(frontierPath, &start, sizeof(CachedCube));
+        queued[start.idx] = true;
+    }
 
     const int BUFFER_SIZE = 10000000;
     char* outputBuffer = new char[BUFFER_SIZE * sizeof(CachedCube)];
     char* inputBuffer = new char[BUFFER_SIZE * sizeof(CachedCube)];
 
-    int processed = 0;
-
     while (frontierSize) {
-        std::string nextFrontierPath = "data/tmp/frontier-" + std::to_string(depth + 1) + ".bin";
+        std::string nextFrontierPath = frontierFile(depth + 1);
         std::ofstream nextFrontierOut(nextFrontierPath, std::ios::binary);
-        int nextFrontierSize = 0;
+        uint64_t nextFrontierSize = 0;
 
         std::ifstream frontierIn(frontierPath, std::ios::binary);
 
@@ -86,7 +103,7 @@ void genDataDisk(KeyGetter keyGetter, const std::function<void(uint64_t, uint8_t
 
         auto currDepthStart = std::chrono::high_resolution_clock::now();
         std::cout << "Processing depth " << depth << " with " << frontierSize << " cubes" << std::endl;
-        for (int i = 0; i < frontierSize; i++) {
+        for (uint64_t i = 0; i < frontierSize; i++) {
             if (inputBufferPos >= inputBufferCount) {
                 frontierIn.read(inputBuffer, BUFFER_SIZE * sizeof(CachedCube));
                 inputBufferCount = frontierIn.gcount() / sizeof(CachedCube);
@@ -137,6 +154,11 @@ void genDataDisk(KeyGetter keyGetter, const std::function<void(uint64_t, uint8_t
         frontierSize = nextFrontierSize;
         depth++;
 
+        if (checkpoint) {
+            TableCheckpoint::writeFile(checkpoint->getFilePath("queued", depth), queued, size);
+            checkpoint->commit(depth, frontierSize, processed);
+        }
+
         std::cout << "Finished processing depth " << depth - 1 << " in " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - currDepthStart).count() << " ms" << std::endl;
     }
 
@@ -146,10 +168,43 @@ void genDataDisk(KeyGetter keyGetter, const std::function<void(uint64_t, uint8_t
 
     std::cout << "Final depth: " << depth - 1 << std::endl;
 
-    //Delete all tmp files
-    for (int i = 0; i <= depth; i++) {
-        std::string path = "data/tmp/frontier-" + std::to_string(i) + ".bin";
-        remove(path.c_str());
+    //Delete all tmp files, a checkpoint cleans up after itself once the table is saved
+    if (!checkpoint) {
+        for (int i = 0; i <= depth; i++) {
+            std::string path = "data/tmp/frontier-" + std::to_string(i) + ".bin";
+            remove(path.c_str());
+        }
+    }
+}
+
+//Builds the same table as genDataDisk with performBFSExternal, cubeGetter has to turn a key back into a cube with that key
+template<typename KeyGetter, typename CubeGetter>
+void genDataExternal(KeyGetter keyGetter, CubeGetter cubeGetter, const std::function<void(uint64_t, uint8_t)>& setter, uint64_t size, TableCheckpoint* checkpoint = nullptr) {
+    FastRubiksCube startCube;
+
+    performBFSExternal(
+            keyGetter(startCube),
+            size,
+            [&](uint64_t idx, std::vector<uint64_t>& out) {
+                FastRubiksCube cube = cubeGetter(idx);
+                for (int j = 0; j < 18; j++) {
+                    FastRubiksCube nextCube = cube.doMove(j);
+                    out.push_back(keyGetter(nextCube));
+                }
+            },
+            [&](uint8_t depth, uint64_t idx) {
+                setter(idx, depth);
+            },
+            checkpoint
+    );
+}
+
+template<typename KeyGetter, typename CubeGetter>
+void genData(KeyGetter keyGetter, CubeGetter cubeGetter, const std::function<void(uint64_t, uint8_t)>& setter, uint64_t size, TableCheckpoint& checkpoint) {
+    if (useExternalBFS()) {
+        genDataExternal(keyGetter, cubeGetter, setter, size, &checkpoint);
+    } else {
+        genDataDisk(keyGetter, setter, size, &checkpoint);
     }
 }
 
@@ -188,6 +243,17 @@ struct PartialEdgeKeyGetter {
     }
 };
 
+template<size_t GroupSize>
+struct PartialEdgeCubeGetter {
+    std::array<Edge, GroupSize> group;
+
+    PartialEdgeCubeGetter(std::array<Edge, GroupSize> group) : group(group) {}
+
+    inline FastRubiksCube operator()(uint64_t idx) {
+        return FastRubiksCube::fromPartialEdgeIndex(group, idx);
+    }
+};
+
 const uint64_t NUM_CORNER_INDICES = fact(8) * bpow(3, 7);
 std::string FULL_CORNERS_PATH = "data/corners.bin";
 
@@ -201,35 +267,105 @@ std::string EDGE_PERMS_PATH = "data/edge_perms.bin";
 const uint64_t NUM_EDGE_CROSS_INDICES = fact(12) / fact(8) * bpow(2, 4);
 std::string EDGE_CROSS_ONE_PATH = "data/edge_cross_one.bin";
 
-Database<uint8_t> LOWER_BOUND_CORNERS(NUM_CORNER_INDICES, "data/corners.bin", [](uint8_t* out) {
+Database<uint8_t> LOWER_BOUND_CORNERS(NUM_CORNER_INDICES, "data/corners.bin", [](uint8_t* out, TableCheckpoint& checkpoint) {
     struct KeyGetter {
         inline uint32_t operator()(FastRubiksCube& cube) {
             return cube.getCornerIndex();
         }
     } keyGetter;
 
-    genDataDisk(keyGetter, basicSetter(out), NUM_CORNER_INDICES);
+    genData(keyGetter, FastRubiksCube::fromCornerIndex, basicSetter(out), NUM_CORNER_INDICES, checkpoint);
 });
 
-Database<uint8_t> LOWER_BOUND_PARTIAL_EDGES_GROUP_1(NUM_PARTIAL_EDGE_INDICES, PARTIAL_EDGES_GROUP_1_PATH, [](uint8_t* out) {
-    genDataDisk(PartialEdgeKeyGetter(EDGE_GROUP_ONE), interspersedSetter(out), NUM_PARTIAL_EDGE_INDICES);
+Database<uint8_t> LOWER_BOUND_PARTIAL_EDGES_GROUP_1(NUM_PARTIAL_EDGE_INDICES, PARTIAL_EDGES_GROUP_1_PATH, [](uint8_t* out, TableCheckpoint& checkpoint) {
+    genData(PartialEdgeKeyGetter(EDGE_GROUP_ONE), PartialEdgeCubeGetter(EDGE_GROUP_ONE), interspersedSetter(out), NUM_PARTIAL_EDGE_INDICES, checkpoint);
 });
-Database<uint8_t> LOWER_BOUND_PARTIAL_EDGES_GROUP_2(NUM_PARTIAL_EDGE_INDICES, PARTIAL_EDGES_GROUP_2_PATH, [](uint8_t* out) {
-    genDataDisk(PartialEdgeKeyGetter(EDGE_GROUP_TWO), interspersedSetter(out), NUM_PARTIAL_EDGE_INDICES);
+Database<uint8_t> LOWER_BOUND_PARTIAL_EDGES_GROUP_2(NUM_PARTIAL_EDGE_INDICES, PARTIAL_EDGES_GROUP_2_PATH, [](uint8_t* out, TableCheckpoint& checkpoint) {
+    genData(PartialEdgeKeyGetter(EDGE_GROUP_TWO), PartialEdgeCubeGetter(EDGE_GROUP_TWO), interspersedSetter(out), NUM_PARTIAL_EDGE_INDICES, checkpoint);
 });
 
-Database<uint8_t> LOWER_BOUND_EDGE_PERMS(NUM_EDGE_PERM_INDICES, EDGE_PERMS_PATH, [](uint8_t* out) {
+Database<uint8_t> LOWER_BOUND_EDGE_PERMS(NUM_EDGE_PERM_INDICES, EDGE_PERMS_PATH, [](uint8_t* out, TableCheckpoint& checkpoint) {
     struct KeyGetter {
         inline uint32_t operator()(FastRubiksCube& cube) {
             return cube.getEdgePermutationIndex();
         }
     } keyGetter;
 
-    genDataDisk(keyGetter, basicSetter(out), NUM_EDGE_PERM_INDICES);
+    genData(keyGetter, FastRubiksCube::fromEdgePermutationIndex, basicSetter(out), NUM_EDGE_PERM_INDICES, checkpoint);
 });
 
-Database<uint8_t> LOWER_BOUND_EDGE_CROSS_ONE(NUM_EDGE_CROSS_INDICES, EDGE_CROSS_ONE_PATH, [](uint8_t* out) {
-    genDataDisk(PartialEdgeKeyGetter(EDGE_GROUP_CROSS_ONE), interspersedSetter(out), NUM_PARTIAL_EDGE_INDICES / 2);
+Database<uint8_t> LOWER_BOUND_EDGE_CROSS_ONE(NUM_EDGE_CROSS_INDICES, EDGE_CROSS_ONE_PATH, [](uint8_t* out, TableCheckpoint& checkpoint) {
+    genData(PartialEdgeKeyGetter(EDGE_GROUP_CROSS_ONE), PartialEdgeCubeGetter(EDGE_GROUP_CROSS_ONE), interspersedSetter(out), NUM_EDGE_CROSS_INDICES, checkpoint);
+});
+
+struct F2LSlot {
+    Edge edge;
+    Corner corner;
+};
+
+//In the order the CFOP solver numbers them
+constexpr F2LSlot F2L_SLOTS[4] = {
+        {Edge::FRONT_LEFT, Corner::TOP_LEFT_FRONT},
+        {Edge::FRONT_RIGHT, Corner::TOP_RIGHT_FRONT},
+        {Edge::BACK_RIGHT, Corner::TOP_RIGHT_BACK},
+        {Edge::BACK_LEFT, Corner::TOP_LEFT_BACK},
+};
+
+/*
+ * Distance to the cross plus the front left pair. The other slots use the same table: turning the whole cube around U
+ * keeps the cross where it is and moves any slot onto the front left one, so a slot's distance is the table value of
+ * the rotated cube.
+ */
+std::array<Edge, 5> EDGE_GROUP_F2L_PAIR = {Edge::TOP_BACK, Edge::TOP_LEFT, Edge::TOP_RIGHT, Edge::TOP_FRONT, Edge::FRONT_LEFT};
+const Corner F2L_PAIR_CORNER = Corner::TOP_LEFT_FRONT;
+
+const uint64_t NUM_F2L_PAIR_INDICES = fact(12) / fact(7) * bpow(2, 5) * 24;
+std::string F2L_PAIR_PATH = "data/f2l_pair.bin";
+
+//The applySymmetry index that moves slot onto the front left one, see applyBasicSymmetry for why it's S.edges that has
+//to point at the slot
+constexpr int getSlotSymmetry(int slot) {
+    for (int i = 0; i < 4; i++) {
+        if (S_U4_POWERS[i].edges[Edge::FRONT_LEFT] == F2L_SLOTS[slot].edge && S_U4_POWERS[i].corners[F2L_PAIR_CORNER] == F2L_SLOTS[slot].corner) {
+            return 2 * i;
+        }
+    }
+
+    return -1;
+}
+
+constexpr int F2L_SLOT_SYMMETRIES[4] = {getSlotSymmetry(0), getSlotSymmetry(1), getSlotSymmetry(2), getSlotSymmetry(3)};
+static_assert(F2L_SLOT_SYMMETRIES[0] == 0 && F2L_SLOT_SYMMETRIES[1] != -1 && F2L_SLOT_SYMMETRIES[2] != -1 && F2L_SLOT_SYMMETRIES[3] != -1, "Every slot has to be a U turn away from the front left one");
+
+inline uint64_t getF2LPairIndex(const FastRubiksCube& cube) {
+    return cube.getPartialEdgeIndex(EDGE_GROUP_F2L_PAIR) * 24 + cube.corners[F2L_PAIR_CORNER] * 3 + cube.cornerOrientations[F2L_PAIR_CORNER];
+}
+
+FastRubiksCube fromF2LPairIndex(uint64_t index) {
+    FastRubiksCube cube = FastRubiksCube::fromPartialEdgeIndex(EDGE_GROUP_F2L_PAIR, index / 24);
+    uint8_t position = index % 24 / 3;
+
+    //Whichever corner was at position takes the pair corner's place, like with the edges nothing else matters
+    for (int i = 0; i < 8; i++) {
+        if (cube.corners[i] == position) {
+            cube.corners[i] = cube.corners[F2L_PAIR_CORNER];
+        }
+    }
+
+    cube.corners[F2L_PAIR_CORNER] = position;
+    cube.cornerOrientations[F2L_PAIR_CORNER] = index % 3;
+
+    return cube;
+}
+
+Database<uint8_t> F2L_PAIR_TABLE((NUM_F2L_PAIR_INDICES + 1) / 2, F2L_PAIR_PATH, [](uint8_t* out, TableCheckpoint& checkpoint) {
+    struct KeyGetter {
+        inline uint64_t operator()(FastRubiksCube& cube) {
+            return getF2LPairIndex(cube);
+        }
+    } keyGetter;
+
+    genData(keyGetter, fromF2LPairIndex, interspersedSetter(out), NUM_F2L_PAIR_INDICES, checkpoint);
 });
 
 void initSolver() {
@@ -244,7 +380,7 @@ void initSolver() {
 }
 
 template<typename IsSolvedFunc, typename HeuristicFunc, int MoveCount>
-bool solveAtDepth(FastRubiksCube& cube, RedundantMovePreventor rmp, int depth, std::vector<int>& out, IsSolvedFunc& isSolvedFunc, HeuristicFunc heuristicFunc, std::array<int, MoveCount>& moves, bool& halt) {
+bool solveAtDepth(FastRubiksCube& cube, RedundantMovePreventor rmp, int depth, std::vector<int>& out, IsSolvedFunc& isSolvedFunc, HeuristicFunc heuristicFunc, std::array<int, MoveCount>& moves, std::atomic<bool>& halt) {
     uint8_t dist = heuristicFunc(cube);
 
     if (halt) return true;
@@ -278,7 +414,7 @@ bool solveAtDepth(FastRubiksCube& cube, RedundantMovePreventor rmp, int depth, s
 }
 
 template<typename IsSolvedFunc, typename HeuristicFunc, int MoveCount>
-std::optional<std::vector<int>> solveIDAStar(FastRubiksCube cube, IsSolvedFunc isSolvedFunc, HeuristicFunc heuristicFunc, std::array<int, MoveCount> moves, bool& halt, int maxDepth = 20) {
+std::optional<std::vector<int>> solveIDAStar(FastRubiksCube cube, IsSolvedFunc isSolvedFunc, HeuristicFunc heuristicFunc, std::array<int, MoveCount> moves, std::atomic<bool>& halt, int maxDepth = 20) {
     std::vector<int> out;
 
     for (int i = 0; i <= maxDepth && !halt; i++) {
@@ -295,42 +431,230 @@ std::optional<std::vector<int>> solveIDAStar(FastRubiksCube cube, IsSolvedFunc i
 
 const std::array<int, 18> ALL_MOVES_ARR = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17};
 template<typename IsSolvedFunc, typename HeuristicFunc>
-std::optional<std::vector<int>> solveIDAStarAllMoves(FastRubiksCube cube, IsSolvedFunc isSolvedFunc, HeuristicFunc heuristicFunc, bool& halt, int maxMoves = 20) {
+std::optional<std::vector<int>> solveIDAStarAllMoves(FastRubiksCube cube, IsSolvedFunc isSolvedFunc, HeuristicFunc heuristicFunc, std::atomic<bool>& halt, int maxMoves = 20) {
     return solveIDAStar<IsSolvedFunc, HeuristicFunc, 18>(cube, isSolvedFunc, heuristicFunc, ALL_MOVES_ARR, halt, maxMoves);
 }
 
-std::optional<std::vector<int>> solveKorf(FastRubiksCube cube, bool& halt, int maxMoves = 20) {
+//Iterations below this bound finish faster than the threads for them start
+const int PARALLEL_MIN_DEPTH = 8;
+//The search tree is split into the subtrees below every move sequence of this length, about 3000 once redundant ones
+//are dropped, which is plenty to keep all threads busy until the last few subtrees
+const int PARALLEL_PREFIX_DEPTH = 3;
+
+struct SearchPrefix {
+    FastRubiksCube cube;
+    RedundantMovePreventor rmp;
+    std::vector<int> moves;
+};
+
+template<int MoveCount>
+void enumeratePrefixes(const FastRubiksCube& cube, RedundantMovePreventor rmp, int depth, std::vector<int>& path, std::array<int, MoveCount>& moves, std::vector<SearchPrefix>& out) {
+    if (depth == 0) {
+        out.push_back({cube, rmp, path});
+        return;
+    }
+
+    for (int i = 0; i < MoveCount; i++) {
+        if (rmp.isRedundant(ALL_MOVES[moves[i]])) {
+            continue;
+        }
+
+        RedundantMovePreventor nextRMP = rmp;
+        nextRMP.turnFace(ALL_MOVES[moves[i]].side);
+
+        path.push_back(moves[i]);
+        enumeratePrefixes<MoveCount>(cube.doMove(moves[i]), nextRMP, depth - 1, path, moves, out);
+        path.pop_back();
+    }
+}
+
+//Like solveAtDepth, but reports every solution of exactly depth more moves through onSolution instead of stopping at
+//the first one. path holds the moves that led to cube
+template<typename IsSolvedFunc, typename HeuristicFunc, typename SolutionFunc, int MoveCount>
+void searchAtDepth(FastRubiksCube& cube, RedundantMovePreventor rmp, int depth, std::vector<int>& path, IsSolvedFunc& isSolvedFunc, HeuristicFunc& heuristicFunc, SolutionFunc& onSolution, std::array<int, MoveCount>& moves, std::atomic<bool>& stop, std::atomic<bool>& halt) {
+    if (stop || halt) return;
+
+    uint8_t dist = heuristicFunc(cube);
+
+    if (dist > depth) {
+        return;
+    }
+
+    if (depth == 0) {
+        if (isSolvedFunc(cube)) {
+            onSolution(path);
+        }
+        return;
+    }
+
+    for (int i = 0; i < MoveCount; i++) {
+        if (rmp.isRedundant(ALL_MOVES[moves[i]])) {
+            continue;
+        }
+
+        FastRubiksCube next = cube.doMove(moves[i]);
+        RedundantMovePreventor nextRMP = rmp;
+        nextRMP.turnFace(ALL_MOVES[moves[i]].side);
+
+        path.push_back(moves[i]);
+        searchAtDepth<IsSolvedFunc, HeuristicFunc, SolutionFunc, MoveCount>(next, nextRMP, depth - 1, path, isSolvedFunc, heuristicFunc, onSolution, moves, stop, halt);
+        path.pop_back();
+    }
+}
+
+/*
+ * IDA* with every iteration spread over all cores. Each iteration splits the tree into the subtrees below all
+ * non-redundant PARALLEL_PREFIX_DEPTH move prefixes and hands those out with runWorkStealing.
+ *
+ * Without allSolutions every thread stops as soon as one of them finds a solution at the current bound, so the result
+ * has one solution. With it the iteration runs to the end and every optimal solution is returned, sorted so the result
+ * doesn't depend on thread timing. Returns nothing if there is no solution within maxDepth or halt was set.
+ */
+template<typename IsSolvedFunc, typename HeuristicFunc, int MoveCount>
+std::vector<std::vector<int>> solveIDAStarParallel(FastRubiksCube cube, IsSolvedFunc isSolvedFunc, HeuristicFunc heuristicFunc, std::array<int, MoveCount> moves, std::atomic<bool>& halt, int maxDepth, bool allSolutions) {
+    std::vector<std::vector<int>> solutions;
+    std::mutex solutionsMutex;
+    std::atomic<bool> stop = false;
+
+    auto onSolution = [&](const std::vector<int>& path) {
+        std::lock_guard<std::mutex> lock(solutionsMutex);
+        solutions.push_back(path);
+
+        if (!allSolutions) {
+            stop = true;
+        }
+    };
+
+    int numThreads = std::max(1, (int) std::thread::hardware_concurrency());
+
+    for (int depth = 0; depth <= maxDepth && !halt; depth++) {
+        std::cout << "Trying to solve cube in " << depth << " moves!" << std::endl;
+
+        if (depth < PARALLEL_MIN_DEPTH || numThreads == 1) {
+            std::vector<int> path;
+            searchAtDepth<IsSolvedFunc, HeuristicFunc, decltype(onSolution), MoveCount>(cube, RedundantMovePreventor(), depth, path, isSolvedFunc, heuristicFunc, onSolution, moves, stop, halt);
+        } else {
+            std::vector<SearchPrefix> prefixes;
+            std::vector<int> path;
+            enumeratePrefixes<MoveCount>(cube, RedundantMovePreventor(), PARALLEL_PREFIX_DEPTH, path, moves, prefixes);
+
+            runWorkStealing(numThreads, (int) prefixes.size(), [&](int i) {
+                SearchPrefix& prefix = prefixes[i];
+                std::vector<int> prefixPath = prefix.moves;
+
+                searchAtDepth<IsSolvedFunc, HeuristicFunc, decltype(onSolution), MoveCount>(prefix.cube, prefix.rmp, depth - PARALLEL_PREFIX_DEPTH, prefixPath, isSolvedFunc, heuristicFunc, onSolution, moves, stop, halt);
+            });
+        }
+
+        if (!solutions.empty()) {
+            std::sort(solutions.begin(), solutions.end());
+            return solutions;
+        }
+    }
+
+    return {};
+}
+
+static void ensureKorfTablesLoaded() {
     LOWER_BOUND_CORNERS.ensureLoaded();
     LOWER_BOUND_PARTIAL_EDGES_GROUP_1.ensureLoaded();
     LOWER_BOUND_PARTIAL_EDGES_GROUP_2.ensureLoaded();
     LOWER_BOUND_EDGE_PERMS.ensureLoaded();
+}
 
-    auto isSolvedFunc = [](FastRubiksCube& cube) {
-        return cube.isSolved();
-    };
+static uint8_t korfHeuristic(FastRubiksCube& cube) {
+    uint8_t res = LOWER_BOUND_CORNERS.ptr[cube.getCornerIndex()];
+    res = std::max(
+            res,
+            getInterspersedValue(LOWER_BOUND_PARTIAL_EDGES_GROUP_1.ptr, cube.getPartialEdgeIndex(EDGE_GROUP_ONE))
+    );
+    res = std::max(
+            res,
+            getInterspersedValue(LOWER_BOUND_PARTIAL_EDGES_GROUP_2.ptr, cube.getPartialEdgeIndex(EDGE_GROUP_TWO))
+    );
+    res = std::max(
+            res,
+            getInterspersedValue(LOWER_BOUND_EDGE_PERMS.ptr, cube.getEdgePermutationIndex())
+    );
+
+    return res;
+}
+
+static bool isCubeSolved(FastRubiksCube& cube) {
+    return cube.isSolved();
+}
+
+static std::vector<std::vector<int>> searchKorf(FastRubiksCube cube, std::atomic<bool>& halt, int maxMoves, bool allSolutions) {
+    ensureKorfTablesLoaded();
+
+    auto isSolvedFunc = isCubeSolved;
+    auto heuristicFunc = korfHeuristic;
+
+    return solveIDAStarParallel<decltype(isSolvedFunc), decltype(heuristicFunc), 18>(cube, isSolvedFunc, heuristicFunc, ALL_MOVES_ARR, halt, maxMoves, allSolutions);
+}
 
-    auto heuristicFunc = [](FastRubiksCube& cube) {
-        uint8_t res = LOWER_BOUND_CORNERS.ptr[cube.getCornerIndex()];
-        res = std::max(
-                res,
-                getInterspersedValue(LOWER_BOUND_PARTIAL_EDGES_GROUP_1.ptr, cube.getPartialEdgeIndex(EDGE_GROUP_ONE))
-        );
-        res = std::max(
-                res,
-                getInterspersedValue(LOWER_BOUND_PARTIAL_EDGES_GROUP_2.ptr, cube.getPartialEdgeIndex(EDGE_GROUP_TWO))
-        );
-        res = std::max(
-                res,
-                getInterspersedValue(LOWER_BOUND_EDGE_PERMS.ptr, cube.getEdgePermutationIndex())
-        );
+std::optional<std::vector<int>> solveKorf(FastRubiksCube cube, std::atomic<bool>& halt, int maxMoves) {
+    auto solutions = searchKorf(cube, halt, maxMoves, false);
+
+    if (solutions.empty()) {
+        return std::nullopt;
+    }
+
+    return solutions[0];
+}
+
+std::vector<std::vector<int>> solveKorfAll(FastRubiksCube cube, std::atomic<bool>& halt, int maxMoves) {
+    return searchKorf(cube, halt, maxMoves, true);
+}
+
+//Goal of the F2L stage that has the first Pairs pairs of an order in place
+template<size_t Pairs>
+struct F2LGoal {
+    std::array<Edge, 4 + Pairs> edges;
+    std::array<Corner, Pairs> corners;
+
+    inline bool operator()(FastRubiksCube& cube) {
+        return cube.isPartiallySolved(edges) && cube.isPartiallySolved(corners);
+    }
+};
+
+template<size_t Pairs>
+struct F2LHeuristic {
+    std::array<int, Pairs> slots;
+
+    inline uint8_t operator()(FastRubiksCube& cube) {
+        uint8_t res = 0;
+
+        for (int slot: slots) {
+            FastRubiksCube rotated = applySymmetry(cube, F2L_SLOT_SYMMETRIES[slot]);
+            res = std::max(res, getInterspersedValue(F2L_PAIR_TABLE.ptr, getF2LPairIndex(rotated)));
+        }
 
         return res;
-    };
+    }
+};
+
+template<size_t Pairs>
+std::optional<std::vector<int>> solveF2LStage(FastRubiksCube cube, const std::vector<int>& order, std::atomic<bool>& halt) {
+    F2LGoal<Pairs> goal;
+    F2LHeuristic<Pairs> heuristic;
+
+    for (int i = 0; i < 4; i++) {
+        goal.edges[i] = EDGE_GROUP_CROSS_ONE[i];
+    }
+
+    for (int i = 0; i < Pairs; i++) {
+        goal.edges[4 + i] = F2L_SLOTS[order[i]].edge;
+        goal.corners[i] = F2L_SLOTS[order[i]].corner;
+        heuristic.slots[i] = order[i];
+    }
 
-    return solveIDAStarAllMoves(cube, isSolvedFunc, heuristicFunc, halt, maxMoves);
+    return solveIDAStarAllMoves(cube, goal, heuristic, halt);
 }
 
-std::optional<std::vector<int>> solveCFOP(FastRubiksCube cube, bool& halt) {
+//With optimalLastLayer the last layer is solved optimally with the Korf tables instead of looked up in the last layer
+//table, which gives shorter solutions but needs the big tables and takes far longer
+std::optional<std::vector<int>> solveCFOP(FastRubiksCube cube, std::atomic<bool>& halt, bool optimalLastLayer = false) {
     std::vector<int> res;
 
     LOWER_BOUND_EDGE_CROSS_ONE.ensureLoaded();
@@ -354,39 +678,36 @@ std::optional<std::vector<int>> solveCFOP(FastRubiksCube cube, bool& halt) {
         res.push_back(move);
     }
 
-    std::vector<std::pair<Edge, Corner>> cornerOrder = {
-            {Edge::FRONT_LEFT, Corner::TOP_LEFT_FRONT},
-            {Edge::FRONT_RIGHT, Corner::TOP_RIGHT_FRONT},
-            {Edge::BACK_RIGHT, Corner::TOP_RIGHT_BACK},
-            {Edge::BACK_LEFT, Corner::TOP_LEFT_BACK},
-    };
-
-    std::vector<std::vector<int>> allPerms;
+    std::vector<std::vector<int>> orders;
     std::vector<int> p = {0, 1, 2, 3};
     do {
-        std::vector<Edge> toSolveEdges(EDGE_GROUP_CROSS_ONE.begin(), EDGE_GROUP_CROSS_ONE.end());
-        std::vector<Corner> toSolveCorners;
+        orders.push_back(p);
+    } while (std::next_permutation(p.begin(), p.end()));
 
+    F2L_PAIR_TABLE.ensureLoaded();
+    int numThreads = std::max(1, (int) std::thread::hardware_concurrency());
+
+    //Every pair order only depends on the cross, so they are all solved at the same time
+    std::vector<std::optional<std::vector<int>>> allPerms(orders.size());
+    std::vector<FastRubiksCube> lastLayerCubes(orders.size());
+
+    runWorkStealing(numThreads, (int) orders.size(), [&](int j) {
         std::vector<int> currMoves;
         FastRubiksCube currCube = cube;
 
         for (int i = 0; i < 4; i++) {
-            if (halt) return std::nullopt;
-            Corner corner = cornerOrder[p[i]].second;
-            Edge edge = cornerOrder[p[i]].first;
-
-            toSolveCorners.push_back(corner);
-            toSolveEdges.push_back(edge);
-
-            auto f = [&toSolveEdges, &toSolveCorners](FastRubiksCube& cube) {
-                return cube.isPartiallySolved(toSolveEdges) && cube.isPartiallySolved(toSolveCorners);
-            };
-
-            auto moves = solveIDAStarAllMoves(currCube, f, crossHeuristicFunc, halt);
-
+            if (halt) return;
+
+            std::optional<std::vector<int>> moves;
+            switch (i) {
+                case 0: moves = solveF2LStage<1>(currCube, orders[j], halt); break;
+                case 1: moves = solveF2LStage<2>(currCube, orders[j], halt); break;
+                case 2: moves = solveF2LStage<3>(currCube, orders[j], halt); break;
+                case 3: moves = solveF2LStage<4>(currCube, orders[j], halt); break;
+            }
 
             if (!moves) {
-                return std::nullopt;
+                return;
             }
 
             for (int move : *moves) {
@@ -395,40 +716,112 @@ std::optional<std::vector<int>> solveCFOP(FastRubiksCube cube, bool& halt) {
             }
         }
 
-        allPerms.push_back(currMoves);
-    } while (std::next_permutation(p.begin(), p.end()));
+        allPerms[j] = currMoves;
+        lastLayerCubes[j] = currCube;
+    });
 
-    for (int i = 0; i <= 14; i++) {
-        for (int j = 0; j < allPerms.size(); j++) {
-            if (halt) return std::nullopt;
+    for (auto& perm: allPerms) {
+        if (!perm) {
+            return std::nullopt;
+        }
+    }
 
-            FastRubiksCube currCube = cube;
+    if (!optimalLastLayer) {
+        //Table lookups are cheap enough to pick the order with the shortest total
+        std::optional<std::vector<int>> best;
 
-            for (int move : allPerms[j]) {
-                currCube = currCube.doMove(move);
+        for (int j = 0; j < (int) orders.size(); j++) {
+            auto lastLayer = solveLastLayer(lastLayerCubes[j]);
+            if (!lastLayer) {
+                return std::nullopt;
             }
 
-            auto moves = solveKorf(currCube, halt, i);
+            std::vector<int> moves = allPerms[j].value();
+            moves.insert(moves.end(), lastLayer->begin(), lastLayer->end());
 
-            if (moves) {
-                for (int move: allPerms[j]) {
-                    res.push_back(move);
-                }
+            if (!best || moves.size() < best->size()) {
+                best = moves;
+            }
+        }
+
+        res.insert(res.end(), best->begin(), best->end());
+        return res;
+    }
 
-                for (int move : *moves) {
-                    res.push_back(move);
+    ensureKorfTablesLoaded();
+
+    /*
+     * The last layer of every pair order is searched at the same time, each one deepening on its own. The best result
+     * so far is kept as depth * 32 + order, so the shortest last layer wins and ties go to the earlier order like they
+     * did when the orders were tried one after the other. Once a result comes in, every search that can't beat it any
+     * more is stopped.
+     */
+    const int MAX_LAST_LAYER_MOVES = 14;
+    auto key = [](int depth, int order) {
+        return depth * 32 + order;
+    };
+
+    struct LastLayerSearch {
+        std::atomic<int> depth = -1;
+        std::atomic<bool> stop = false;
+    };
+
+    std::vector<LastLayerSearch> searches(orders.size());
+    std::atomic<int> bestKey = key(MAX_LAST_LAYER_MOVES + 1, 0);
+    std::mutex bestMutex;
+    std::vector<int> bestMoves;
+
+    runWorkStealing(numThreads, (int) orders.size(), [&](int j) {
+        auto isSolvedFunc = isCubeSolved;
+        auto heuristicFunc = korfHeuristic;
+        std::array<int, 18> moves = ALL_MOVES_ARR;
+
+        for (int depth = 0; key(depth, j) < bestKey && !halt; depth++) {
+            searches[j].depth = depth;
+
+            //bestKey could have dropped before the store above was visible to whoever lowered it
+            if (key(depth, j) >= bestKey) break;
+
+            auto onSolution = [&](const std::vector<int>& lastLayerMoves) {
+                std::lock_guard<std::mutex> lock(bestMutex);
+                searches[j].stop = true;
+
+                if (key(depth, j) >= bestKey) return;
+
+                bestKey = key(depth, j);
+                bestMoves = allPerms[j].value();
+                bestMoves.insert(bestMoves.end(), lastLayerMoves.begin(), lastLayerMoves.end());
+
+                for (int k = 0; k < (int) searches.size(); k++) {
+                    if (key(searches[k].depth, k) > bestKey) {
+                        searches[k].stop = true;
+                    }
                 }
+            };
 
-                return res;
-            }
+            std::vector<int> path;
+            searchAtDepth<decltype(isSolvedFunc), decltype(heuristicFunc), decltype(onSolution), 18>(lastLayerCubes[j], RedundantMovePreventor(), depth, path, isSolvedFunc, heuristicFunc, onSolution, moves, searches[j].stop, halt);
+
+            if (searches[j].stop) break;
         }
+    });
+
+    if (halt || bestKey >= key(MAX_LAST_LAYER_MOVES + 1, 0)) {
+        return std::nullopt;
     }
 
-    return std::nullopt;
+    res.insert(res.end(), bestMoves.begin(), bestMoves.end());
+    return res;
 }
 
-std::optional<std::vector<Move>> solve(FastRubiksCube cube, bool& halt, std::function<void (std::string)> statusUpdateCallback) {
-    return kociembaSolve(cube, halt, statusUpdateCallback);
+std::optional<std::vector<Move>> solve(FastRubiksCube cube, std::atomic<bool>& halt, std::function<void (std::string)> statusUpdateCallback, const MoveCostModel* costModel) {
+    auto res = kociembaSolve(cube, halt, statusUpdateCallback, costModel);
+
+    if (!res) {
+        return std::nullopt;
+    }
+
+    return optimizeSolution(*res);
 
     /*auto res = solveCFOP(cube, halt);
 
@@ -1,7 +1,17 @@
 #include "../FastRubiksCube.h"
 #include <vector>
+#include <atomic>
+#include <functional>
+#include <string>
 #include <optional>
+#include "move_cost.h"
 
 void initSolver();
 
-std::optional<std::vector<Move>> solve(FastRubiksCube cube, bool& halt, std::function<void (std::string)> statusUpdateCallback);
\ No newline at end of file
+//Optimal solves using the Korf pattern databases, searched on all cores
+std::optional<std::vector<int>> solveKorf(FastRubiksCube cube, std::atomic<bool>& halt, int maxMoves = 20);
+//Every optimal solution instead of just one, or nothing if the cube needs more than maxMoves
+std::vector<std::vector<int>> solveKorfAll(FastRubiksCube cube, std::atomic<bool>& halt, int maxMoves = 20);
+
+//costModel picks between solutions of similar length, nullptr keeps the shortest
+std::optional<std::vector<Move>> solve(FastRubiksCube cube, std::atomic<bool>& halt, std::function<void (std::string)> statusUpdateCallback, const MoveCostModel* costModel = nullptr);
\ No newline at end of file
@@ -0,0 +1,295 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#include "solver_service.h"
+#include "solver.h"
+#include "solution_optimizer.h"
+#include "symmetry.h"
+
+#include <algorithm>
+
+SolverService::SolverService(int numWorkers) {
+    if (numWorkers <= 0) {
+        numWorkers = (int) std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (int i = 0; i < numWorkers; i++) {
+        workers.emplace_back(&SolverService::workerLoop, this);
+    }
+    watchdog = std::thread(&SolverService::watchdogLoop, this);
+}
+
+SolverService::~SolverService() {
+    cancelAll();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_all();
+    deadlineChanged.notify_all();
+
+    for (std::thread& worker: workers) {
+        worker.join();
+    }
+    watchdog.join();
+}
+
+SolveTicket SolverService::submit(const FastRubiksCube& cube, SolveBudget budget, Callback onDone) {
+    auto job = std::make_shared<Job>();
+    job->cube = cube;
+    job->budget = budget;
+    job->onDone = std::move(onDone);
+
+    SolveTicket ticket;
+    ticket.result = job->promise.get_future().share();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job->id = nextJobId++;
+        jobs[job->id] = job;
+        queue.push_back(job);
+    }
+    jobAvailable.notify_one();
+
+    ticket.jobId = job->id;
+    return ticket;
+}
+
+bool SolverService::cancel(uint64_t jobId) {
+    std::shared_ptr<Job> unstarted;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = jobs.find(jobId);
+        if (it == jobs.end()) {
+            return false;
+        }
+
+        std::shared_ptr<Job> job = it->second;
+        job->cancelled = true;
+
+        if (job->running) {
+            //The worker reports the result once the search notices
+            job->halt = true;
+            job->status = "Stopping";
+            return true;
+        }
+
+        queue.erase(std::find(queue.begin(), queue.end(), job));
+        jobs.erase(it);
+        unstarted = job;
+    }
+
+    SolveResult result;
+    result.jobId = jobId;
+    result.cancelled = true;
+
+    if (unstarted->onDone) {
+        unstarted->onDone(result);
+    }
+    unstarted->promise.set_value(result);
+
+    return true;
+}
+
+void SolverService::cancelAll() {
+    std::vector<uint64_t> ids;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& [id, job]: jobs) {
+            ids.push_back(id);
+        }
+    }
+
+    for (uint64_t id: ids) {
+        cancel(id);
+    }
+}
+
+std::string SolverService::getStatus(uint64_t jobId) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = jobs.find(jobId);
+    if (it == jobs.end()) {
+        return "";
+    }
+
+    return it->second->status;
+}
+
+void SolverService::workerLoop() {
+    while (true) {
+        std::shared_ptr<Job> job;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this]() { return stopping || !queue.empty(); });
+
+            if (stopping) {
+                return;
+            }
+
+            job = queue.front();
+            queue.pop_front();
+
+            job->running = true;
+            job->status = "";
+            if (job->budget.timeLimit.count() > 0) {
+                job->deadline = Clock::now() + job->budget.timeLimit;
+            }
+        }
+        deadlineChanged.notify_one();
+
+        runJob(job);
+    }
+}
+
+void SolverService::watchdogLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (!stopping) {
+        auto now = Clock::now();
+        auto nextDeadline = Clock::time_point::max();
+
+        for (auto& [id, job]: jobs) {
+            if (!job->running || job->halt) continue;
+
+            if (now >= job->deadline) {
+                job->halt = true;
+            } else {
+                nextDeadline = std::min(nextDeadline, job->deadline);
+            }
+        }
+
+        if (nextDeadline == Clock::time_point::max()) {
+            deadlineChanged.wait(lock);
+        } else {
+            deadlineChanged.wait_until(lock, nextDeadline);
+        }
+    }
+}
+
+void SolverService::runJob(const std::shared_ptr<Job>& job) {
+    auto updateStatus = [this, job](std::string msg) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!job->cancelled) {
+            job->status = std::move(msg);
+        }
+    };
+
+    std::optional<std::vector<Move>> moves;
+    bool cached;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        moves = findCachedSolution(job->cube, job->budget);
+        cached = moves.has_value();
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    if (!cached) {
+        moves = solve(job->cube, job->halt, updateStatus, job->budget.costModel);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    SolveResult result;
+    result.jobId = job->id;
+    result.moves = std::move(moves);
+    result.timeTaken = end - start;
+    result.cached = cached;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        result.cancelled = job->cancelled;
+        jobs.erase(job->id);
+
+        //A cancelled search stopped at some arbitrary point, its solution says nothing about what the budget finds
+        if (!cached && !result.cancelled && result.moves) {
+            cacheSolution(job->cube, job->budget, *result.moves);
+        }
+    }
+
+    if (job->onDone) {
+        job->onDone(result);
+    }
+    job->promise.set_value(result);
+}
+
+bool SolverService::CubeOrder::operator()(const FastRubiksCube& a, const FastRubiksCube& b) const {
+    return cubeLess(a, b);
+}
+
+//Whether a search with time limit a looks at least as long as one with time limit b, 0 being no limit
+static bool searchesLonger(std::chrono::milliseconds a, std::chrono::milliseconds b) {
+    return a.count() == 0 || (b.count() != 0 && a >= b);
+}
+
+std::optional<std::vector<Move>> SolverService::findCachedSolution(const FastRubiksCube& cube, SolveBudget budget) {
+    if (budget.costModel) {
+        return std::nullopt;
+    }
+
+    CanonicalCube canonical = canonicalize(cube, true);
+
+    auto it = solutionCache.find(canonical.cube);
+    //A solution found with less time might be longer than what this job's search would find
+    if (it == solutionCache.end() || !searchesLonger(it->second.timeLimit, budget.timeLimit)) {
+        return std::nullopt;
+    }
+
+    std::vector<Move> moves;
+    for (int move: fromCanonicalSolution(it->second.moves, canonical)) {
+        moves.push_back(ALL_MOVES[move]);
+    }
+
+    return moves;
+}
+
+void SolverService::cacheSolution(const FastRubiksCube& cube, SolveBudget budget, const std::vector<Move>& moves) {
+    if (budget.costModel) {
+        return;
+    }
+
+    CanonicalCube canonical = canonicalize(cube, true);
+
+    //Solves canonical.cube instead of cube, the reverse of fromCanonicalSolution
+    std::vector<int> canonicalMoves;
+    for (const Move& move: moves) {
+        canonicalMoves.push_back(moveIndex(move));
+    }
+
+    if (canonical.inverted) {
+        std::reverse(canonicalMoves.begin(), canonicalMoves.end());
+        for (int& move: canonicalMoves) {
+            move = inverseMove(move);
+        }
+    }
+
+    for (int& move: canonicalMoves) {
+        move = FULL_SYM_MOVES[canonical.symmetry][move];
+    }
+
+    auto it = solutionCache.find(canonical.cube);
+
+    if (it != solutionCache.end()) {
+        //The shorter solution is at least as good as what either search finds
+        if (canonicalMoves.size() < it->second.moves.size()) {
+            it->second.moves = canonicalMoves;
+        }
+        if (!searchesLonger(it->second.timeLimit, budget.timeLimit)) {
+            it->second.timeLimit = budget.timeLimit;
+        }
+        return;
+    }
+
+    if (solutionCache.size() == SOLUTION_CACHE_SIZE) {
+        solutionCache.erase(cacheOrder.front());
+        cacheOrder.pop_front();
+    }
+
+    solutionCache[canonical.cube] = {canonicalMoves, budget.timeLimit};
+    cacheOrder.push_back(canonical.cube);
+}
@@ -0,0 +1,150 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_SOLVER_SERVICE_H
+#define RUBIK_SOLVER_SERVICE_H
+
+#include "../FastRubiksCube.h"
+#include "move_cost.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct SolveBudget {
+    //How long the search may look for shorter solutions, 0 runs it until it's exhausted or cancelled
+    std::chrono::milliseconds timeLimit{0};
+    //Has to outlive the job, nullptr keeps the shortest solution
+    const MoveCostModel* costModel = nullptr;
+};
+
+struct SolveResult {
+    uint64_t jobId = 0;
+    //The best solution found, even if the job was cancelled or ran out of time
+    std::optional<std::vector<Move>> moves;
+    bool cancelled = false;
+    //Spent searching, not waiting in the queue
+    std::chrono::duration<double> timeTaken{0};
+    //Taken from an earlier job on a cube of the same symmetry class, no search was done
+    bool cached = false;
+};
+
+struct SolveTicket {
+    uint64_t jobId = 0;
+    std::shared_future<SolveResult> result;
+
+    //Never blocks
+    [[nodiscard]] bool isReady() const {
+        return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+};
+
+/*
+ * Solves cubes on a fixed pool of worker threads. Each job gets a snapshot of the cube taken when it's submitted, so the
+ * caller can keep changing its own cube, and reports back through a future and an optional callback (called on the
+ * worker thread, or on the cancelling thread for a job that never started). A job can be cancelled by id whether it's
+ * still queued or already searching. Every method returns straight away, the only lock the caller ever waits on guards
+ * the queue and is never held during a search.
+ *
+ * Shortest solutions are remembered by the canonical cube of their class under the 48 symmetries and inversion (see
+ * canonicalize), so a cube that is a rotation, mirror image or inverse of one solved before is answered without a
+ * search. Jobs with a cost model aren't cached, robot costs depend on which faces get turned and in what order.
+ */
+class SolverService {
+public:
+    using Callback = std::function<void(const SolveResult&)>;
+
+    //0 for one worker per core
+    explicit SolverService(int numWorkers = 1);
+    //Cancels everything still queued or running
+    ~SolverService();
+
+    SolverService(const SolverService&) = delete;
+    SolverService& operator=(const SolverService&) = delete;
+
+    SolveTicket submit(const FastRubiksCube& cube, SolveBudget budget = {}, Callback onDone = nullptr);
+
+    //False if the job already finished
+    bool cancel(uint64_t jobId);
+    void cancelAll();
+
+    //Latest progress message of a queued or running job, empty once it has finished
+    std::string getStatus(uint64_t jobId);
+
+    [[nodiscard]] int getNumWorkers() const {
+        return (int) workers.size();
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    //Solutions kept at most, the oldest is forgotten first
+    static constexpr size_t SOLUTION_CACHE_SIZE = 4096;
+
+    struct CubeOrder {
+        bool operator()(const FastRubiksCube& a, const FastRubiksCube& b) const;
+    };
+
+    struct CachedSolution {
+        //Move indices solving the canonical cube
+        std::vector<int> moves;
+        //The time limit it was found with, 0 if the search ran to the end
+        std::chrono::milliseconds timeLimit;
+    };
+
+    struct Job {
+        uint64_t id;
+        FastRubiksCube cube;
+        SolveBudget budget;
+        Callback onDone;
+        std::promise<SolveResult> promise;
+
+        std::string status = "Queued";
+        bool running = false;
+        bool cancelled = false;
+        //Polled by the search threads without the service mutex
+        std::atomic<bool> halt = false;
+        Clock::time_point deadline = Clock::time_point::max();
+    };
+
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable deadlineChanged;
+
+    std::deque<std::shared_ptr<Job>> queue;
+    //Every queued or running job
+    std::unordered_map<uint64_t, std::shared_ptr<Job>> jobs;
+    uint64_t nextJobId = 1;
+    bool stopping = false;
+
+    std::map<FastRubiksCube, CachedSolution, CubeOrder> solutionCache;
+    //Keys of solutionCache, oldest first
+    std::deque<FastRubiksCube> cacheOrder;
+
+    std::vector<std::thread> workers;
+    //Halts running jobs once their time limit has passed
+    std::thread watchdog;
+
+    void workerLoop();
+    void watchdogLoop();
+    void runJob(const std::shared_ptr<Job>& job);
+
+    //These expect mutex to be held
+    std::optional<std::vector<Move>> findCachedSolution(const FastRubiksCube& cube, SolveBudget budget);
+    void cacheSolution(const FastRubiksCube& cube, SolveBudget budget, const std::vector<Move>& moves);
+};
+
+#endif //RUBIK_SOLVER_SERVICE_H
@@ -3,23 +3,295 @@
 //
 
 #include "solver_util.h"
+#include "sorted_index_file.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <filesystem>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
 
 TempFileProvider::TempFileProvider()
     :paths()
 {
     std::filesystem::create_directory("tmp");
+
+    //create_directory only succeeds for a name nobody (in this process or another) is using yet
+    std::random_device random;
+    do {
+        directory = "tmp/bfs_" + std::to_string(random());
+    } while (!std::filesystem::create_directory(directory));
 }
 
 TempFileProvider::~TempFileProvider() {
     for (const std::string& path : paths) {
         std::filesystem::remove(path);
     }
+    std::filesystem::remove(directory);
 }
 
 std::string TempFileProvider::getNewTempFile() {
-    std::string path = "tmp/temp_" + std::to_string(paths.size()) + ".bin";
+    std::string path = directory + "/temp_" + std::to_string(paths.size()) + ".bin";
     paths.push_back(path);
     return path;
 }
+
+bool useExternalBFS() {
+    const char* value = std::getenv("RUBIK_EXTERNAL_BFS");
+    return value != nullptr && std::string(value) != "0";
+}
+
+//Memory used by all the run buffers together
+static const uint64_t EXTERNAL_BFS_RUN_MEMORY = 1ull << 29;
+static const int EXTERNAL_BFS_PARTITIONS = 64;
+
+void performBFSExternal(
+        uint64_t baseIndex,
+        uint64_t numElements,
+        const std::function<void (uint64_t idx, std::vector<uint64_t>& out)>& expand,
+        const std::function<void (uint8_t depth, uint64_t idx)>& callback,
+        TableCheckpoint* checkpoint
+    ) {
+    auto start = std::chrono::high_resolution_clock::now();
+    TempFileProvider tempFileProvider;
+    std::mutex tempFileMutex;
+
+    auto newTempFile = [&]() {
+        std::lock_guard<std::mutex> lock(tempFileMutex);
+        return tempFileProvider.getNewTempFile();
+    };
+
+    int numThreads = std::max(1, (int) std::thread::hardware_concurrency());
+
+    //Enough partitions that one slow partition doesn't hold up the rest. This doesn't depend on the number of threads so
+    //a checkpoint can be resumed on another machine
+    uint64_t partitionSize = (numElements + EXTERNAL_BFS_PARTITIONS - 1) / EXTERNAL_BFS_PARTITIONS;
+    partitionSize = (partitionSize + 63) & ~63ull;
+    int numPartitions = (int) ((numElements + partitionSize - 1) / partitionSize);
+
+    uint64_t runEntries = EXTERNAL_BFS_RUN_MEMORY / sizeof(uint64_t) / numThreads;
+
+    //Layers have to survive a restart when checkpointing, the runs never do
+    auto layerFile = [&](int layerDepth, int partition) {
+        if (checkpoint) {
+            std::string path = checkpoint->getFilePath("layer-" + std::to_string(layerDepth) + "-" + std::to_string(partition));
+            std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+            return path;
+        }
+        return newTempFile();
+    };
+
+    //layers[depth][partition]
+    std::vector<std::vector<std::string>> layers;
+
+    uint64_t frontierSize = 1;
+    uint64_t processed = 0;
+    int depth = 0;
+
+    if (checkpoint && checkpoint->hasSavedState()) {
+        depth = checkpoint->getDepth();
+        frontierSize = checkpoint->getFrontierSize();
+        processed = checkpoint->getProcessed();
+
+        for (int d = 0; d <= depth; d++) {
+            layers.emplace_back();
+            for (int p = 0; p < numPartitions; p++) {
+                layers[d].push_back(layerFile(d, p));
+            }
+        }
+    } else {
+        layers.emplace_back();
+        for (int p = 0; p < numPartitions; p++) {
+            std::string path = layerFile(0, p);
+            SortedIndexWriter writer(path);
+            if (baseIndex / partitionSize == p) {
+                writer.push(baseIndex);
+            }
+            layers[0].push_back(path);
+        }
+
+        if (checkpoint) {
+            checkpoint->commit(0, frontierSize, processed, false);
+        }
+    }
+
+    while (frontierSize) {
+        auto currDepthStart = std::chrono::high_resolution_clock::now();
+        std::cout << "Processing depth " << depth << " with " << frontierSize << " elements" << std::endl;
+        processed += frontierSize;
+
+        //Expand the frontier into sorted runs, split by the partition their indices fall in so every merge below only
+        //opens the runs of its own partition
+        std::vector<std::vector<std::string>> runs(numPartitions);
+        std::mutex runsMutex;
+
+        runWorkStealing(numThreads, numPartitions, [&](int partition) {
+            std::vector<uint64_t> buffer;
+            buffer.reserve(runEntries);
+            std::vector<uint64_t> children;
+
+            auto flushRun = [&]() {
+                std::sort(buffer.begin(), buffer.end());
+                buffer.erase(std::unique(buffer.begin(), buffer.end()), buffer.end());
+
+                auto begin = buffer.begin();
+                while (begin != buffer.end()) {
+                    int runPartition = (int) (*begin / partitionSize);
+                    auto end = std::lower_bound(begin, buffer.end(), (runPartition + 1) * partitionSize);
+
+                    std::string path = newTempFile();
+                    SortedIndexWriter writer(path);
+                    for (auto it = begin; it != end; it++) {
+                        writer.push(*it);
+                    }
+                    writer.close();
+
+                    {
+                        std::lock_guard<std::mutex> lock(runsMutex);
+                        runs[runPartition].push_back(path);
+                    }
+
+                    begin = end;
+                }
+
+                buffer.clear();
+            };
+
+            SortedIndexReader reader(layers[depth][partition]);
+            uint64_t idx;
+            while (reader.next(idx)) {
+                children.clear();
+                expand(idx, children);
+                buffer.insert(buffer.end(), children.begin(), children.end());
+
+                if (buffer.size() >= runEntries) {
+                    flushRun();
+                }
+            }
+
+            if (!buffer.empty()) {
+                flushRun();
+            }
+        });
+
+        //Merge the runs partition by partition, dropping everything that is already in an earlier layer
+        std::vector<std::string> nextLayer(numPartitions);
+        std::atomic<uint64_t> nextFrontierSize = 0;
+
+        runWorkStealing(numThreads, numPartitions, [&](int partition) {
+            std::vector<std::unique_ptr<SortedIndexReader>> runReaders;
+            typedef std::pair<uint64_t, int> HeapEntry;
+            std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<>> heap;
+
+            for (const std::string& run: runs[partition]) {
+                runReaders.push_back(std::make_unique<SortedIndexReader>(run));
+
+                uint64_t idx;
+                if (runReaders.back()->next(idx)) {
+                    heap.emplace(idx, (int) runReaders.size() - 1);
+                }
+            }
+
+            std::vector<std::unique_ptr<SortedIndexReader>> seenReaders;
+            std::vector<uint64_t> seenHeads;
+            for (int d = 0; d <= depth; d++) {
+                seenReaders.push_back(std::make_unique<SortedIndexReader>(layers[d][partition]));
+                uint64_t idx;
+                seenHeads.push_back(seenReaders.back()->next(idx) ? idx : UINT64_MAX);
+            }
+
+            nextLayer[partition] = layerFile(depth + 1, partition);
+            SortedIndexWriter writer(nextLayer[partition]);
+
+            bool first = true;
+            uint64_t last = 0;
+
+            while (!heap.empty()) {
+                auto [idx, runIdx] = heap.top();
+                heap.pop();
+
+                uint64_t next;
+                if (runReaders[runIdx]->next(next)) {
+                    heap.emplace(next, runIdx);
+                }
+
+                if (!first && idx == last) continue;
+                first = false;
+                last = idx;
+
+                bool seen = false;
+                for (size_t i = 0; i < seenReaders.size(); i++) {
+                    while (seenHeads[i] < idx) {
+                        if (!seenReaders[i]->next(seenHeads[i])) seenHeads[i] = UINT64_MAX;
+                    }
+                    seen |= seenHeads[i] == idx;
+                }
+
+                if (!seen) {
+                    writer.push(idx);
+                }
+            }
+
+            writer.close();
+            nextFrontierSize += writer.size();
+        });
+
+        for (const std::vector<std::string>& partitionRuns: runs) {
+            for (const std::string& run: partitionRuns) {
+                std::filesystem::remove(run);
+            }
+        }
+
+        layers.push_back(nextLayer);
+        frontierSize = nextFrontierSize;
+        depth++;
+
+        if (checkpoint) {
+            //The table is only written once all layers are done, no point in saving it
+            checkpoint->commit(depth, frontierSize, processed, false);
+        }
+
+        std::cout << "Finished processing depth " << depth - 1 << " in " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - currDepthStart).count() << " ms" << std::endl;
+        progressBar(processed, numElements, start);
+    }
+
+    //Every index is in exactly one layer, merging them gives each index with its depth in order
+    runWorkStealing(numThreads, numPartitions, [&](int partition) {
+        std::vector<std::unique_ptr<SortedIndexReader>> readers;
+        typedef std::pair<uint64_t, int> HeapEntry;
+        std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<>> heap;
+
+        for (int d = 0; d < layers.size(); d++) {
+            readers.push_back(std::make_unique<SortedIndexReader>(layers[d][partition]));
+
+            uint64_t idx;
+            if (readers.back()->next(idx)) {
+                heap.emplace(idx, d);
+            }
+        }
+
+        while (!heap.empty()) {
+            auto [idx, d] = heap.top();
+            heap.pop();
+
+            callback(d, idx);
+
+            uint64_t next;
+            if (readers[d]->next(next)) {
+                heap.emplace(next, d);
+            }
+        }
+    });
+
+    std::cout << "Final depth: " << depth - 1 << std::endl;
+    std::cout << "Total time: " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count() << " ms" << std::endl;
+    std::cout << "Total processed: " << processed << std::endl;
+
+    if (processed != numElements) {
+        std::cout << "ERROR: processed != size" << std::endl;
+    }
+}
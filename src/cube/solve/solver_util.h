@@ -11,12 +11,17 @@
 #include <functional>
 #include <string>
 #include <fstream>
+#include "util/WorkStealing.h"
+#include "checkpoint.h"
 
+//Every provider gets a directory of its own under tmp, so tables generated at the same time don't overwrite each
+//other's files
 struct TempFileProvider {
     TempFileProvider();
     TempFileProvider(const TempFileProvider&) = delete;
     ~TempFileProvider();
 
+    std::string directory;
     std::vector<std::string> paths;
 
     std::string getNewTempFile();
@@ -43,39 +48,97 @@ static void progressBar(int progress, int total, std::chrono::time_point<Clock>
     std::cout.flush();
 }
 
+//Set RUBIK_EXTERNAL_BFS=1 to build tables with performBFSExternal instead of keeping a visited array in memory
+bool useExternalBFS();
+
+/*
+ * External memory BFS, nothing proportional to numElements is kept in memory.
+ *
+ * Every layer is stored as sorted, delta encoded index files (see sorted_index_file.h), split into partitions of the
+ * index space. Worker threads expand the current layer into sorted runs, split by partition as well, then the runs of
+ * each partition are merged against the same partition of all earlier layers and anything already seen is dropped. Checking only the last two layers would be enough
+ * on the full cube graph, but not on the symmetry reduced pruning coordinates, where a coordinate's neighbours depend
+ * on which cube it was reached from. The layers are small compared to the runs so this is cheap.
+ *
+ * Once the search is done all layers are merged again so callback sees every index exactly once in increasing order.
+ * Different partitions are handed to callback from different threads at the same time, partitions are aligned to 64
+ * indices so packed tables (like the interspersed ones) can be written without locking.
+ */
+void performBFSExternal(
+        uint64_t baseIndex,
+        uint64_t numElements,
+        const std::function<void (uint64_t idx, std::vector<uint64_t>& out)>& expand,
+        const std::function<void (uint8_t depth, uint64_t idx)>& callback,
+        TableCheckpoint* checkpoint = nullptr
+    );
+
+template<typename State>
+static void performBFSExternal(
+        State baseState,
+        uint64_t numElements,
+        std::function<uint64_t (const State&)> stateToIndex,
+        std::function<State (uint64_t)> indexToState,
+        std::function<std::vector<State> (const State&)> getNextStates,
+        std::function<void (uint8_t depth, uint64_t idx)> callback,
+        TableCheckpoint* checkpoint = nullptr
+    ) {
+    performBFSExternal(
+            stateToIndex(baseState),
+            numElements,
+            [&](uint64_t idx, std::vector<uint64_t>& out) {
+                for (const State& next: getNextStates(indexToState(idx))) {
+                    out.push_back(stateToIndex(next));
+                }
+            },
+            callback,
+            checkpoint
+    );
+}
+
 template<typename State>
 static void performBFSDisk(
         State baseState,
         uint64_t numElements,
         std::function<uint64_t (const State&)> stateToIndex,
         std::function<std::vector<State> (const State&)> getNextStates,
-        std::function<void (uint8_t depth, uint64_t idx, const State&)> callback
+        std::function<void (uint8_t depth, uint64_t idx, const State&)> callback,
+        TableCheckpoint* checkpoint = nullptr
     ) {
 
     auto start = std::chrono::high_resolution_clock::now();
     TempFileProvider tempFileProvider;
 
+    auto frontierFile = [&](int frontierDepth) {
+        return checkpoint ? checkpoint->getFilePath("frontier", frontierDepth) : tempFileProvider.getNewTempFile();
+    };
+
     std::vector<bool> queued(numElements, false);
 
     int depth = 0;
-
-    std::string frontierPath = tempFileProvider.getNewTempFile();
-    std::ofstream frontierOut(frontierPath, std::ios::binary);
-    frontierOut.write((char*) &baseState, sizeof(State));
-    frontierOut.close();
-    queued[stateToIndex(baseState)] = true;
-    int frontierSize = 1;
+    std::string frontierPath;
+    uint64_t frontierSize = 1;
+    uint64_t processed = 0;
+
+    if (checkpoint && checkpoint->hasSavedState()) {
+        depth = checkpoint->getDepth();
+        frontierPath = checkpoint->getFilePath("frontier", depth);
+        frontierSize = checkpoint->getFrontierSize();
+        processed = checkpoint->getProcessed();
+        TableCheckpoint::readBits(checkpoint->getFilePath("visited", depth), queued);
+    } else {
+        frontierPath = frontierFile(0);
+        TableCheckpoint::writeFile(frontierPath, &baseState, sizeof(State));
+        queued[stateToIndex(baseState)] = true;
+    }
 
     const int BUFFER_SIZE = 10000000;
     char* outputBuffer = new char[BUFFER_SIZE * sizeof(State)];
     char* inputBuffer = new char[BUFFER_SIZE * sizeof(State)];
 
-    int processed = 0;
-
     while (frontierSize) {
-        std::string nextFrontierPath = tempFileProvider.getNewTempFile();
+        std::string nextFrontierPath = frontierFile(depth + 1);
         std::ofstream nextFrontierOut(nextFrontierPath, std::ios::binary);
-        int nextFrontierSize = 0;
+        uint64_t nextFrontierSize = 0;
 
         std::ifstream frontierIn(frontierPath, std::ios::binary);
 
@@ -85,7 +148,7 @@ static void performBFSDisk(
 
         auto currDepthStart = std::chrono::high_resolution_clock::now();
         std::cout << "Processing depth " << depth << " with " << frontierSize << " elements" << std::endl;
-        for (int i = 0; i < frontierSize; i++) {
+        for (uint64_t i = 0; i < frontierSize; i++) {
             if (inputBufferPos >= inputBufferCount) {
                 frontierIn.read(inputBuffer, BUFFER_SIZE * sizeof(State));
                 inputBufferCount = frontierIn.gcount() / sizeof(State);
@@ -134,6 +197,11 @@ static void performBFSDisk(
         frontierSize = nextFrontierSize;
         depth++;
 
+        if (checkpoint) {
+            TableCheckpoint::writeBits(checkpoint->getFilePath("visited", depth), queued);
+            checkpoint->commit(depth, frontierSize, processed);
+        }
+
         std::cout << "Finished processing depth " << depth - 1 << " in " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - currDepthStart).count() << " ms" << std::endl;
     }
 
@@ -0,0 +1,126 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#include "sorted_index_file.h"
+#include <iostream>
+
+SortedIndexWriter::SortedIndexWriter(const std::string& path)
+    :out(path, std::ios::binary)
+{
+    if (!out) {
+        std::cerr << "Couldn't open " << path << std::endl;
+        exit(1);
+    }
+}
+
+SortedIndexWriter::~SortedIndexWriter() {
+    close();
+}
+
+void SortedIndexWriter::push(uint64_t value) {
+    uint64_t delta = value;
+
+    if (inBlock == 0) {
+        blocks.push_back({value, offset});
+    } else {
+        delta = value - last;
+    }
+
+    while (delta >= 0x80) {
+        blockBuffer.push_back((uint8_t) (delta | 0x80));
+        delta >>= 7;
+    }
+    blockBuffer.push_back((uint8_t) delta);
+
+    last = value;
+    numEntries++;
+    inBlock++;
+
+    if (inBlock == BLOCK_ENTRIES) {
+        flushBlock();
+    }
+}
+
+void SortedIndexWriter::flushBlock() {
+    out.write((char*) blockBuffer.data(), blockBuffer.size());
+    offset += blockBuffer.size();
+    blockBuffer.clear();
+    inBlock = 0;
+}
+
+void SortedIndexWriter::close() {
+    if (closed) return;
+    closed = true;
+
+    flushBlock();
+
+    uint64_t numBlocks = blocks.size();
+    out.write((char*) blocks.data(), numBlocks * sizeof(SortedIndexBlock));
+    out.write((char*) &numBlocks, sizeof(uint64_t));
+    out.write((char*) &numEntries, sizeof(uint64_t));
+    out.close();
+}
+
+SortedIndexReader::SortedIndexReader(const std::string& path)
+    :in(path, std::ios::binary)
+{
+    if (!in) {
+        std::cerr << "Couldn't open " << path << std::endl;
+        exit(1);
+    }
+
+    uint64_t numBlocks;
+    in.seekg(-2 * (std::streamoff) sizeof(uint64_t), std::ios::end);
+    in.read((char*) &numBlocks, sizeof(uint64_t));
+    in.read((char*) &numEntries, sizeof(uint64_t));
+
+    blocks.resize(numBlocks);
+    in.seekg(-2 * (std::streamoff) sizeof(uint64_t) - (std::streamoff) (numBlocks * sizeof(SortedIndexBlock)), std::ios::end);
+    dataEnd = in.tellg();
+    in.read((char*) blocks.data(), numBlocks * sizeof(SortedIndexBlock));
+
+    loadBlock(0);
+}
+
+bool SortedIndexReader::loadBlock(size_t block) {
+    currBlock = block;
+    blockPos = 0;
+    atBlockStart = true;
+    blockBuffer.clear();
+
+    if (block >= blocks.size()) {
+        return false;
+    }
+
+    uint64_t end = block + 1 < blocks.size() ? blocks[block + 1].offset : dataEnd;
+    blockBuffer.resize(end - blocks[block].offset);
+
+    in.seekg(blocks[block].offset);
+    in.read((char*) blockBuffer.data(), blockBuffer.size());
+
+    return true;
+}
+
+bool SortedIndexReader::next(uint64_t& value) {
+    while (blockPos >= blockBuffer.size()) {
+        if (!loadBlock(currBlock + 1)) {
+            return false;
+        }
+    }
+
+    uint64_t delta = 0;
+    int shift = 0;
+    while (true) {
+        uint8_t byte = blockBuffer[blockPos++];
+        delta |= (uint64_t) (byte & 0x7F) << shift;
+        if (!(byte & 0x80)) break;
+        shift += 7;
+    }
+
+    last = atBlockStart ? delta : last + delta;
+    atBlockStart = false;
+
+    value = last;
+    return true;
+}
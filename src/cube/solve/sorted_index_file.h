@@ -0,0 +1,82 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_SORTED_INDEX_FILE_H
+#define RUBIK_SORTED_INDEX_FILE_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/*
+ * A file of strictly increasing uint64 indices, stored as varint encoded deltas.
+ *
+ * Entries are grouped in blocks of BLOCK_ENTRIES, each block starts from an absolute value so it can be decoded without
+ * the ones before it. The block index sits at the end of the file:
+ *   [block 0][block 1]...[{firstValue, offset} per block][numBlocks][numEntries]
+ */
+
+struct SortedIndexBlock {
+    uint64_t firstValue;
+    uint64_t offset;
+};
+
+class SortedIndexWriter {
+public:
+    static const uint32_t BLOCK_ENTRIES = 4096;
+
+    explicit SortedIndexWriter(const std::string& path);
+    SortedIndexWriter(const SortedIndexWriter&) = delete;
+    ~SortedIndexWriter();
+
+    //Values have to be pushed in strictly increasing order
+    void push(uint64_t value);
+    void close();
+
+    uint64_t size() const {
+        return numEntries;
+    }
+
+private:
+    std::ofstream out;
+    std::vector<uint8_t> blockBuffer;
+    std::vector<SortedIndexBlock> blocks;
+
+    uint64_t numEntries = 0;
+    uint64_t offset = 0;
+    uint64_t last = 0;
+    uint32_t inBlock = 0;
+    bool closed = false;
+
+    void flushBlock();
+};
+
+class SortedIndexReader {
+public:
+    explicit SortedIndexReader(const std::string& path);
+    SortedIndexReader(const SortedIndexReader&) = delete;
+
+    bool next(uint64_t& value);
+
+    uint64_t size() const {
+        return numEntries;
+    }
+
+private:
+    std::ifstream in;
+    std::vector<SortedIndexBlock> blocks;
+    uint64_t numEntries = 0;
+    uint64_t dataEnd = 0;
+
+    std::vector<uint8_t> blockBuffer;
+    size_t blockPos = 0;
+    size_t currBlock = 0;
+    uint64_t last = 0;
+    bool atBlockStart = true;
+
+    bool loadBlock(size_t block);
+};
+
+#endif //RUBIK_SORTED_INDEX_FILE_H
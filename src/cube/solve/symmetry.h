@@ -0,0 +1,456 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_SYMMETRY_H
+#define RUBIK_SYMMETRY_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+#include "cube/FastRubiksCube.h"
+
+/*
+ * The cube symmetries used by the sym-coordinates and the solution cache, all worked out at compile time.
+ *
+ * Everything in here is constexpr so it can't go through CUBE_KERNELS, the compose/invert below are plain copies of the
+ * scalar kernel and FastRubiksCube::inverse. They are only used on small fixed inputs and while building tables.
+ */
+
+//The symmetries that keep the UD axis in place, all the Kociemba sym-coordinates use these
+const int NUM_SYMMETRIES = 16;
+//The whole cube symmetry group, NUM_SYMMETRIES combined with the S_URF3 rotation
+const int NUM_FULL_SYMMETRIES = 48;
+
+constexpr FastRubiksCube composeCubes(const FastRubiksCube& a, const FastRubiksCube& b) {
+    FastRubiksCube result;
+
+    for (int i = 0; i < 8; i++) {
+        result.corners[i] = a.corners[b.corners[i]];
+        result.cornerOrientations[i] = (b.cornerOrientations[i] + a.cornerOrientations[b.corners[i]]) % 3;
+    }
+
+    for (int i = 0; i < 12; i++) {
+        result.edges[i] = a.edges[b.edges[i]];
+        result.edgeOrientations[i] = b.edgeOrientations[i] ^ a.edgeOrientations[b.edges[i]];
+    }
+
+    return result;
+}
+
+constexpr FastRubiksCube invertCube(const FastRubiksCube& cube) {
+    FastRubiksCube result;
+
+    for (int i = 0; i < 8; i++) {
+        result.corners[cube.corners[i]] = i;
+        result.cornerOrientations[cube.corners[i]] = (3 - cube.cornerOrientations[i]) % 3;
+    }
+
+    for (int i = 0; i < 12; i++) {
+        result.edges[cube.edges[i]] = i;
+        result.edgeOrientations[cube.edges[i]] = cube.edgeOrientations[i];
+    }
+
+    return result;
+}
+
+constexpr
+FastRubiksCube makeCube(std::array<std::pair<Corner, std::pair<Corner, int>>, 8> cornerPerm, std::array<std::pair<Edge, std::pair<Edge, int>>, 12> edgePerm) {
+    FastRubiksCube res = {};
+
+    for (int i = 0; i < 8; i++) {
+        res.corners[cornerPerm[i].first] = cornerPerm[i].second.first;
+        res.cornerOrientations[cornerPerm[i].second.first] = cornerPerm[i].second.second;
+    }
+
+    for (int i = 0; i < 12; i++) {
+        res.edges[edgePerm[i].first] = edgePerm[i].second.first;
+        res.edgeOrientations[edgePerm[i].second.first] = edgePerm[i].second.second;
+    }
+
+    return res;
+}
+
+constexpr FastRubiksCube S_F2 = makeCube(
+        std::array<std::pair<Corner, std::pair<Corner, int>>, 8>{
+                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_RIGHT_FRONT, {Corner::BOTTOM_LEFT_FRONT, 0}},
+                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_LEFT_FRONT,  {Corner::TOP_RIGHT_FRONT,  0}},
+
+                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_LEFT_FRONT, {Corner::BOTTOM_RIGHT_FRONT, 0}},
+                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_RIGHT_FRONT,  {Corner::TOP_LEFT_FRONT,  0}},
+
+                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_RIGHT_BACK, {Corner::BOTTOM_LEFT_BACK, 0}},
+                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_LEFT_BACK,  {Corner::TOP_RIGHT_BACK,  0}},
+
+                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_LEFT_BACK, {Corner::BOTTOM_RIGHT_BACK, 0}},
+                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_RIGHT_BACK,  {Corner::TOP_LEFT_BACK,  0}},
+        },
+
+        {
+                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_FRONT, {Edge::BOTTOM_FRONT, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_FRONT, {Edge::TOP_FRONT, 0}},
+
+                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_RIGHT, {Edge::BOTTOM_LEFT, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_LEFT, {Edge::TOP_RIGHT, 0}},
+
+                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_LEFT, {Edge::BOTTOM_RIGHT, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_RIGHT, {Edge::TOP_LEFT, 0}},
+
+                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_BACK, {Edge::BOTTOM_BACK, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_BACK, {Edge::TOP_BACK, 0}},
+
+                std::pair<Edge, std::pair<Edge, int>>{Edge::FRONT_LEFT, {Edge::FRONT_RIGHT, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::FRONT_RIGHT, {Edge::FRONT_LEFT, 0}},
+
+                std::pair<Edge, std::pair<Edge, int>>{Edge::BACK_LEFT, {Edge::BACK_RIGHT, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::BACK_RIGHT, {Edge::BACK_LEFT, 0}},
+        }
+);
+
+//Clockwise turn of cube around U axis
+constexpr FastRubiksCube S_U4 = makeCube(
+        std::array<std::pair<Corner, std::pair<Corner, int>>, 8>{
+                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_RIGHT_FRONT, {Corner::TOP_LEFT_FRONT, 0}},
+                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_LEFT_FRONT,  {Corner::TOP_LEFT_BACK,  0}},
+                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_LEFT_BACK,   {Corner::TOP_RIGHT_BACK, 0}},
+                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_RIGHT_BACK,  {Corner::TOP_RIGHT_FRONT, 0}},
+
+                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_RIGHT_FRONT, {Corner::BOTTOM_LEFT_FRONT, 0}},
+                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_LEFT_FRONT,  {Corner::BOTTOM_LEFT_BACK,  0}},
+                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_LEFT_BACK,   {Corner::BOTTOM_RIGHT_BACK, 0}},
+                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_RIGHT_BACK,  {Corner::BOTTOM_RIGHT_FRONT, 0}}
+        },
+
+        std::array<std::pair<Edge, std::pair<Edge, int>>, 12> {
+                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_FRONT, {Edge::TOP_LEFT, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_LEFT,  {Edge::TOP_BACK, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_BACK,  {Edge::TOP_RIGHT, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_RIGHT, {Edge::TOP_FRONT, 0}},
+
+                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_FRONT, {Edge::BOTTOM_LEFT, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_LEFT,  {Edge::BOTTOM_BACK, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_BACK,  {Edge::BOTTOM_RIGHT, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_RIGHT, {Edge::BOTTOM_FRONT, 0}},
+
+                std::pair<Edge, std::pair<Edge, int>>{Edge::FRONT_LEFT,  {Edge::BACK_LEFT, 1}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::BACK_LEFT,   {Edge::BACK_RIGHT, 1}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::BACK_RIGHT,  {Edge::FRONT_RIGHT, 1}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::FRONT_RIGHT, {Edge::FRONT_LEFT, 1}}
+        }
+);
+
+constexpr FastRubiksCube S_LR2_BASE = makeCube(
+        std::array<std::pair<Corner, std::pair<Corner, int>>, 8>{
+                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_RIGHT_FRONT, {Corner::TOP_LEFT_FRONT, 0}},
+                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_LEFT_FRONT,  {Corner::TOP_RIGHT_FRONT, 0}},
+
+                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_RIGHT_BACK,  {Corner::TOP_LEFT_BACK,  0}},
+                std::pair<Corner, std::pair<Corner, int>>{Corner::TOP_LEFT_BACK,   {Corner::TOP_RIGHT_BACK,  0}},
+
+                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_RIGHT_FRONT, {Corner::BOTTOM_LEFT_FRONT, 0}},
+                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_LEFT_FRONT,  {Corner::BOTTOM_RIGHT_FRONT, 0}},
+
+                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_RIGHT_BACK,  {Corner::BOTTOM_LEFT_BACK,  0}},
+                std::pair<Corner, std::pair<Corner, int>>{Corner::BOTTOM_LEFT_BACK,   {Corner::BOTTOM_RIGHT_BACK,  0}}
+        },
+
+        std::array<std::pair<Edge, std::pair<Edge, int>>, 12> {
+                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_FRONT, {Edge::TOP_FRONT, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_BACK, {Edge::TOP_BACK, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_FRONT, {Edge::BOTTOM_FRONT, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_BACK, {Edge::BOTTOM_BACK, 0}},
+
+                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_LEFT,  {Edge::TOP_RIGHT, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::TOP_RIGHT, {Edge::TOP_LEFT, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_LEFT,  {Edge::BOTTOM_RIGHT, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::BOTTOM_RIGHT, {Edge::BOTTOM_LEFT, 0}},
+
+                std::pair<Edge, std::pair<Edge, int>>{Edge::FRONT_LEFT,  {Edge::FRONT_RIGHT, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::FRONT_RIGHT, {Edge::FRONT_LEFT, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::BACK_LEFT,  {Edge::BACK_RIGHT, 0}},
+                std::pair<Edge, std::pair<Edge, int>>{Edge::BACK_RIGHT, {Edge::BACK_LEFT, 0}}
+        }
+);
+
+constexpr FastRubiksCube applyBasicSymmetry(const FastRubiksCube& cube, const FastRubiksCube& symmetry) {
+    return composeCubes(composeCubes(invertCube(symmetry), cube), symmetry);
+}
+
+constexpr FastRubiksCube apply_S_F2(const FastRubiksCube& cube) {
+    return applyBasicSymmetry(cube, S_F2);
+}
+
+constexpr FastRubiksCube apply_S_U4(const FastRubiksCube& cube) {
+    return applyBasicSymmetry(cube, S_U4);
+}
+
+constexpr FastRubiksCube apply_S_LR2(const FastRubiksCube& cube) {
+    FastRubiksCube res = applyBasicSymmetry(cube, S_LR2_BASE);
+
+    for (int i = 0; i < 8; i++) {
+        res.cornerOrientations[i] = (3 - res.cornerOrientations[i]) % 3;
+    }
+
+    return res;
+}
+
+//Applying S_U4 k times is the same as applying S_U4^k once, which keeps the table generation below cheap
+constexpr FastRubiksCube S_U4_POWERS[4] = {
+        FastRubiksCube(), S_U4, composeCubes(S_U4, S_U4), composeCubes(S_U4, composeCubes(S_U4, S_U4))
+};
+
+//idx = 8 * LR2 + 2 * U4 + F2, applied in that order
+constexpr FastRubiksCube applySymmetry(const FastRubiksCube& cube, int idx) {
+    FastRubiksCube res = cube;
+
+    if (idx >= 8) {
+        res = apply_S_LR2(res);
+        idx -= 8;
+    }
+
+    if (idx >= 2) {
+        res = applyBasicSymmetry(res, S_U4_POWERS[idx / 2]);
+    }
+
+    if (idx % 2 == 1) {
+        res = apply_S_F2(res);
+    }
+
+    return res;
+}
+
+constexpr FastRubiksCube makeMoveCube(std::array<uint8_t, 8> corners, std::array<uint8_t, 8> cornerOrientations, std::array<uint8_t, 12> edges, std::array<uint8_t, 12> edgeOrientations) {
+    FastRubiksCube res;
+
+    for (int i = 0; i < 8; i++) {
+        res.corners[i] = corners[i];
+        res.cornerOrientations[i] = cornerOrientations[i];
+    }
+
+    for (int i = 0; i < 12; i++) {
+        res.edges[i] = edges[i];
+        res.edgeOrientations[i] = edgeOrientations[i];
+    }
+
+    return res;
+}
+
+//Same as FAST_MOVES, which only gets filled in at runtime. Clockwise turns in Side order, the double and
+//counter-clockwise turns are built from them
+constexpr FastRubiksCube CLOCKWISE_MOVE_CUBES[6] = {
+        makeMoveCube({1, 5, 2, 3, 0, 4, 6, 7}, {1, 2, 0, 0, 2, 1, 0, 0}, {4, 1, 2, 3, 8, 5, 6, 0, 7, 9, 10, 11}, {1, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 0}),
+        makeMoveCube({0, 1, 3, 7, 4, 5, 2, 6}, {0, 0, 1, 2, 0, 0, 2, 1}, {0, 1, 6, 3, 4, 2, 10, 7, 8, 9, 5, 11}, {0, 0, 1, 0, 0, 1, 1, 0, 0, 0, 1, 0}),
+        makeMoveCube({4, 1, 2, 0, 7, 5, 6, 3}, {2, 0, 0, 1, 1, 0, 0, 2}, {0, 1, 2, 7, 4, 5, 3, 11, 8, 9, 10, 6}, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}),
+        makeMoveCube({0, 2, 6, 3, 4, 1, 5, 7}, {0, 1, 2, 0, 0, 2, 1, 0}, {0, 5, 2, 3, 1, 9, 6, 7, 8, 4, 10, 11}, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}),
+        makeMoveCube({3, 0, 1, 2, 4, 5, 6, 7}, {0, 0, 0, 0, 0, 0, 0, 0}, {3, 0, 1, 2, 4, 5, 6, 7, 8, 9, 10, 11}, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}),
+        makeMoveCube({0, 1, 2, 3, 5, 6, 7, 4}, {0, 0, 0, 0, 0, 0, 0, 0}, {0, 1, 2, 3, 4, 5, 6, 7, 9, 10, 11, 8}, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}),
+};
+
+constexpr FastRubiksCube moveCube(int move) {
+    FastRubiksCube res = CLOCKWISE_MOVE_CUBES[move % 6];
+
+    for (int i = 0; i < move / 6; i++) {
+        res = composeCubes(CLOCKWISE_MOVE_CUBES[move % 6], res);
+    }
+
+    return res;
+}
+
+//120 degree turn of the whole cube around the URF-DBL diagonal, U goes to R, R to F and F to U. It's the only
+//generator that moves the UD axis, so it only shows up in the full group
+constexpr FastRubiksCube S_URF3 = makeMoveCube(
+        {5, 1, 0, 4, 6, 2, 3, 7}, {0, 1, 0, 1, 1, 0, 1, 0},
+        {4, 0, 7, 8, 1, 3, 11, 9, 5, 2, 6, 10}, {1, 0, 1, 0, 0, 0, 0, 0, 1, 0, 1, 0}
+);
+
+constexpr FastRubiksCube apply_S_URF3(const FastRubiksCube& cube) {
+    return applyBasicSymmetry(cube, S_URF3);
+}
+
+constexpr FastRubiksCube S_URF3_POWERS[3] = {FastRubiksCube(), S_URF3, composeCubes(S_URF3, S_URF3)};
+
+//idx = 16 * URF3 + sym, S_URF3 is applied first and sym is an index for applySymmetry. The first NUM_SYMMETRIES
+//indices are the same symmetries as in applySymmetry
+constexpr FastRubiksCube applyFullSymmetry(const FastRubiksCube& cube, int idx) {
+    FastRubiksCube res = cube;
+
+    if (idx >= NUM_SYMMETRIES) {
+        res = applyBasicSymmetry(res, S_URF3_POWERS[idx / NUM_SYMMETRIES]);
+    }
+
+    return applySymmetry(res, idx % NUM_SYMMETRIES);
+}
+
+template<int Count>
+struct SymmetryTables {
+    //Apply(Apply(cube, i), reverse[i]) == cube
+    int reverse[Count];
+    //Apply(Apply(cube, i), j) == Apply(cube, mult[i][j])
+    int mult[Count][Count];
+    //Apply(move i, j) is move moves[j][i]
+    uint8_t moves[Count][18];
+
+    //Every entry above was pinned down exactly, checked with a static_assert
+    bool valid;
+};
+
+template<int Count, FastRubiksCube (*Apply)(const FastRubiksCube&, int)>
+constexpr SymmetryTables<Count> computeSymmetryTables() {
+    SymmetryTables<Count> tables = {};
+    tables.valid = true;
+
+    //Scrambled enough that no symmetry leaves it unchanged, so comparing images of this one cube is the same as
+    //comparing the symmetries themselves
+    FastRubiksCube test;
+    const int scramble[12] = {0, 4, 15, 9, 2, 17, 3, 6, 1, 14, 5, 10};
+    for (int move: scramble) {
+        test = composeCubes(moveCube(move), test);
+    }
+
+    FastRubiksCube images[Count];
+    for (int i = 0; i < Count; i++) {
+        images[i] = Apply(test, i);
+    }
+
+    for (int i = 0; i < Count; i++) {
+        int found = 0;
+
+        for (int j = 0; j < Count; j++) {
+            FastRubiksCube res = Apply(images[i], j);
+
+            if (res == test) {
+                tables.reverse[i] = j;
+            }
+
+            for (int k = 0; k < Count; k++) {
+                if (res == images[k]) {
+                    tables.mult[i][j] = k;
+                    found++;
+                }
+            }
+        }
+
+        tables.valid &= found == Count;
+        tables.valid &= Apply(images[i], tables.reverse[i]) == test;
+    }
+
+    FastRubiksCube moves[18];
+    for (int i = 0; i < 18; i++) {
+        moves[i] = moveCube(i);
+    }
+
+    for (int j = 0; j < Count; j++) {
+        for (int i = 0; i < 18; i++) {
+            FastRubiksCube sym = Apply(moves[i], j);
+            int found = 0;
+
+            for (int k = 0; k < 18; k++) {
+                if (sym == moves[k]) {
+                    tables.moves[j][i] = k;
+                    found++;
+                }
+            }
+
+            tables.valid &= found == 1;
+        }
+    }
+
+    return tables;
+}
+
+constexpr SymmetryTables<NUM_SYMMETRIES> SYMMETRY_TABLES = computeSymmetryTables<NUM_SYMMETRIES, applySymmetry>();
+static_assert(SYMMETRY_TABLES.valid, "Symmetry tables aren't unique");
+
+inline constexpr const int (&REVERSE_SYMMETRIES)[NUM_SYMMETRIES] = SYMMETRY_TABLES.reverse;
+inline constexpr const int (&SYM_MULT)[NUM_SYMMETRIES][NUM_SYMMETRIES] = SYMMETRY_TABLES.mult;
+inline constexpr const uint8_t (&SYM_MOVES)[NUM_SYMMETRIES][18] = SYMMETRY_TABLES.moves;
+
+constexpr SymmetryTables<NUM_FULL_SYMMETRIES> FULL_SYMMETRY_TABLES = computeSymmetryTables<NUM_FULL_SYMMETRIES, applyFullSymmetry>();
+static_assert(FULL_SYMMETRY_TABLES.valid, "Full symmetry tables aren't unique");
+
+inline constexpr const int (&FULL_REVERSE_SYMMETRIES)[NUM_FULL_SYMMETRIES] = FULL_SYMMETRY_TABLES.reverse;
+inline constexpr const int (&FULL_SYM_MULT)[NUM_FULL_SYMMETRIES][NUM_FULL_SYMMETRIES] = FULL_SYMMETRY_TABLES.mult;
+inline constexpr const uint8_t (&FULL_SYM_MOVES)[NUM_FULL_SYMMETRIES][18] = FULL_SYMMETRY_TABLES.moves;
+
+constexpr int inverseMove(int move) {
+    if (move < 6) return move + 12;
+    if (move >= 12) return move - 12;
+    return move;
+}
+
+//Plain lexicographic order, only used to pick one cube out of a symmetry class
+constexpr bool cubeLess(const FastRubiksCube& a, const FastRubiksCube& b) {
+    for (int i = 0; i < 8; i++) {
+        if (a.corners[i] != b.corners[i]) return a.corners[i] < b.corners[i];
+    }
+    for (int i = 0; i < 8; i++) {
+        if (a.cornerOrientations[i] != b.cornerOrientations[i]) return a.cornerOrientations[i] < b.cornerOrientations[i];
+    }
+    for (int i = 0; i < 12; i++) {
+        if (a.edges[i] != b.edges[i]) return a.edges[i] < b.edges[i];
+    }
+    for (int i = 0; i < 12; i++) {
+        if (a.edgeOrientations[i] != b.edgeOrientations[i]) return a.edgeOrientations[i] < b.edgeOrientations[i];
+    }
+    return false;
+}
+
+struct CanonicalCube {
+    FastRubiksCube cube;
+    //cube == applyFullSymmetry(original, symmetry), or of the inverse of original if inverted is set
+    int symmetry;
+    bool inverted;
+};
+
+/*
+ * Picks the same representative for every cube of a symmetry class, so anything keyed by whole cubes (the solution
+ * cache, duplicate checks) only has to store one of up to 48 cubes.
+ *
+ * With withInverse the inverse cube is also considered, which doubles the class size to up to 96. That's only valid
+ * for things that don't care about the direction of a solution: a cube and its inverse have the same optimal length
+ * and a solution of one turns into a solution of the other by reversing it, see fromCanonicalSolution. Pruning tables
+ * that only look at part of the cube can't use it since the inverse mixes up which pieces are where.
+ */
+constexpr CanonicalCube canonicalize(const FastRubiksCube& cube, bool withInverse = false) {
+    CanonicalCube best = {cube, 0, false};
+
+    FastRubiksCube inverse = invertCube(cube);
+
+    for (int inverted = 0; inverted < (withInverse ? 2 : 1); inverted++) {
+        const FastRubiksCube& base = inverted ? inverse : cube;
+
+        for (int i = 0; i < NUM_FULL_SYMMETRIES; i++) {
+            FastRubiksCube sym = applyFullSymmetry(base, i);
+
+            if (cubeLess(sym, best.cube)) {
+                best = {sym, i, inverted == 1};
+            }
+        }
+    }
+
+    return best;
+}
+
+//Turns a solution of canonical.cube into a solution of the cube it was made from
+template<typename MoveList>
+MoveList fromCanonicalSolution(const MoveList& moves, const CanonicalCube& canonical) {
+    MoveList res;
+    const uint8_t* symMoves = FULL_SYM_MOVES[FULL_REVERSE_SYMMETRIES[canonical.symmetry]];
+
+    for (auto move: moves) {
+        res.push_back(symMoves[move]);
+    }
+
+    if (canonical.inverted) {
+        //The solution of the inverse, read backwards with every turn undone, solves the cube itself
+        std::reverse(res.begin(), res.end());
+        for (auto& move: res) {
+            move = inverseMove(move);
+        }
+    }
+
+    return res;
+}
+
+#endif //RUBIK_SYMMETRY_H
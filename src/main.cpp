@@ -12,12 +12,85 @@
 #include <iostream>
 #include "cube/FastRubiksCube.h"
 #include "render/CubeScanner.h"
+#include "cube/solve/evaluation.h"
+#include "util/CubeImage.h"
+#include "render/ScannerEvaluation.h"
+#include <fstream>
+#include <sstream>
 #include "optional"
 
-int main() {
+//Every line of the file is a scramble, applied to a solved cube
+static std::vector<RubiksCube> readScrambles(const char* path) {
+    std::ifstream in(path);
+
+    if (!in) {
+        std::cerr << "Couldn't open " << path << std::endl;
+        exit(1);
+    }
+
+    std::vector<RubiksCube> cubes;
+    std::string line;
+
+    while (std::getline(in, line)) {
+        RubiksCube cube;
+        std::istringstream moves(line);
+        std::string token;
+
+        while (moves >> token) {
+            cube.doMove(Move::fromString(token));
+        }
+
+        cubes.push_back(cube);
+    }
+
+    return cubes;
+}
+
+int main(int argc, char** argv) {
+    //rubik --thumbnails <scrambles> <output prefix> [net|view] [atlas] renders without opening a window
+    if (argc > 3 && std::string(argv[1]) == "--thumbnails") {
+        std::vector<RubiksCube> cubes = readScrambles(argv[2]);
+        bool net = argc > 4 && std::string(argv[4]) == "net";
+        bool atlas = argc > 5 && std::string(argv[5]) == "atlas";
+
+        CubeImageStyle style = net ? CubeImageStyle::NET : CubeImageStyle::VIEW;
+        int cellWidth = net ? 120 : 96;
+        int cellHeight = net ? 90 : 96;
+
+        if (atlas) {
+            writeCubeAtlases(cubes, style, cellWidth, cellHeight, 32, 32, argv[3]);
+        } else {
+            writeCubeImages(cubes, style, cellWidth, cellHeight, argv[3]);
+        }
+
+        std::cout << "Rendered " << cubes.size() << " cubes" << std::endl;
+        return 0;
+    }
+
+    //rubik --evaluate-scanner <manifest> [threads] scans recorded faces, see ScannerEvaluation.h for the manifest
+    if (argc > 2 && std::string(argv[1]) == "--evaluate-scanner") {
+        ScannerEvaluationConfig config;
+        config.manifestPath = argv[2];
+        if (argc > 3) config.numThreads = std::stoi(argv[3]);
+
+        runScannerEvaluation(config);
+        return 0;
+    }
+
     std::cout << "Initializing fast cube data!" << std::endl;
     initFastRubiksCubeData();
 
+    //rubik --evaluate [cubes] [deadline in ms] [seed] benchmarks the solver instead of opening the window
+    if (argc > 1 && std::string(argv[1]) == "--evaluate") {
+        EvaluationConfig config;
+        if (argc > 2) config.numCubes = std::stoi(argv[2]);
+        if (argc > 3) config.deadline = std::chrono::milliseconds(std::stoi(argv[3]));
+        if (argc > 4) config.seed = std::stoull(argv[4]);
+
+        runEvaluation(config);
+        return 0;
+    }
+
     CubeRenderer renderer;
     renderer.mainLoop();
 }
@@ -0,0 +1,366 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#include "CubeBatch.h"
+#include "glm/gtc/type_ptr.hpp"
+
+#include <iostream>
+#include <cstddef>
+#include <algorithm>
+
+const char * VERTEX_SHADER = R"(
+#version 330 core
+
+layout (location = 0) in vec3 pos;
+layout (location = 1) in float side;
+layout (location = 2) in vec2 uv;
+
+//Per cubit
+layout (location = 3) in vec3 offset;
+layout (location = 4) in ivec3 sidesA;
+layout (location = 5) in ivec3 sidesB;
+layout (location = 6) in float turning;
+
+//Per cube
+layout (location = 7) in vec4 placement;
+layout (location = 8) in vec4 spin;
+
+uniform mat4 viewProj;
+
+out vec3 color;
+out vec2 texCoord;
+
+//DEFINE COLORS FR
+uniform vec3 colors[7] = vec3[](
+    vec3(1.0, 0.0, 0.0), //RED (FRONT)
+    vec3(1.0, 0.647, 0.0), //ORANGE (BACK)
+    vec3(0.0, 0.0, 1.0), //BLUE (LEFT)
+    vec3(0.0, 1.0, 0.0), //GREEN (RIGHT)
+    vec3(1.0, 1.0, 0.0), //YELLOW (TOP)
+    vec3(1.0, 1.0, 1.0), //WHITE (BOTTOM)
+    vec3(0.0, 0.0, 0.0) //BLACK (OUTSIDE)
+);
+
+void main() {
+    vec3 p = pos + offset;
+
+    //Rodrigues' rotation around the turning face's axis
+    if (turning > 0.5) {
+        float c = cos(spin.w);
+        float s = sin(spin.w);
+        p = p * c + cross(spin.xyz, p) * s + spin.xyz * dot(spin.xyz, p) * (1.0 - c);
+    }
+
+    gl_Position = viewProj * vec4(placement.xyz + placement.w * p, 1.0);
+
+    int i = int(side);
+    int colorIndex = i < 3 ? sidesA[i] : sidesB[i - 3];
+    color = colors[colorIndex];
+    texCoord = uv;
+}
+)";
+
+const char * FRAGMENT_SHADER = R"(
+#version 330 core
+
+in vec3 color;
+in vec2 texCoord;
+
+out vec4 fragColor;
+
+uniform vec3 colors[7];
+
+void main() {
+    //float additional = 0.9 + 0.1 * sin(texCoord.x * 100.0 + texCoord.y * 100.0);
+    float additional = 1.0;
+    fragColor = vec4(additional * color, 1.0);
+
+    if (texCoord.x < 0.05 || texCoord.x > 0.95 || texCoord.y < 0.05 || texCoord.y > 0.95) {
+        fragColor = vec4(additional * colors[6], 1.0);
+    }
+}
+)";
+
+const float CUBE_VERTICES[] = {
+        //FRONT (0)
+        -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 0.0f,
+        0.5f, -0.5f, 0.5f, 0.0f, 1.0f, 0.0f,
+        0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 1.0f,
+        0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 1.0f,
+        -0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f,
+        -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 0.0f,
+
+        //BACK (1)
+        0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f,
+        -0.5f, -0.5f, -0.5f, 1.0f, 1.0f, 0.0f,
+        0.5f, 0.5f, -0.5f, 1.0f, 0.0f, 1.0f,
+        -0.5f, 0.5f, -0.5f, 1.0f, 1.0f, 1.0f,
+        0.5f, 0.5f, -0.5f, 1.0f, 0.0f, 1.0f,
+        -0.5f, -0.5f, -0.5f, 1.0f, 1.0f, 0.0f,
+
+        //LEFT (2)
+        -0.5f, -0.5f, -0.5f, 2.0f, 0.0f, 0.0f,
+        -0.5f, -0.5f, 0.5f, 2.0f, 1.0f, 0.0f,
+        -0.5f, 0.5f, -0.5f, 2.0f, 0.0f, 1.0f,
+        -0.5f, 0.5f, 0.5f, 2.0f, 1.0f, 1.0f,
+        -0.5f, 0.5f, -0.5f, 2.0f, 0.0f, 1.0f,
+        -0.5f, -0.5f, 0.5f, 2.0f, 1.0f, 0.0f,
+
+        //RIGHT (3)
+        0.5f, -0.5f, 0.5f, 3.0f, 0.0f, 0.0f,
+        0.5f, -0.5f, -0.5f, 3.0f, 1.0f, 0.0f,
+        0.5f, 0.5f, -0.5f, 3.0f, 1.0f, 1.0f,
+        0.5f, 0.5f, -0.5f, 3.0f, 1.0f, 1.0f,
+        0.5f, 0.5f, 0.5f, 3.0f, 0.0f, 1.0f,
+        0.5f, -0.5f, 0.5f, 3.0f, 0.0f, 0.0f,
+
+        //TOP (4)
+        -0.5f, 0.5f, 0.5f, 4.0f, 0.0f, 0.0f,
+        0.5f, 0.5f, 0.5f, 4.0f, 1.0f, 0.0f,
+        0.5f, 0.5f, -0.5f, 4.0f, 1.0f, 1.0f,
+        0.5f, 0.5f, -0.5f, 4.0f, 1.0f, 1.0f,
+        -0.5f, 0.5f, -0.5f, 4.0f, 0.0f, 1.0f,
+        -0.5f, 0.5f, 0.5f, 4.0f, 0.0f, 0.0f,
+
+        //BOTTOM (5)
+        0.5f, -0.5f, 0.5f, 5.0f, 0.0f, 0.0f,
+        -0.5f, -0.5f, 0.5f, 5.0f, 1.0f, 0.0f,
+        0.5f, -0.5f, -0.5f, 5.0f, 0.0f, 1.0f,
+        -0.5f, -0.5f, -0.5f, 5.0f, 1.0f, 1.0f,
+        0.5f, -0.5f, -0.5f, 5.0f, 0.0f, 1.0f,
+        -0.5f, -0.5f, 0.5f, 5.0f, 1.0f, 0.0f
+};
+
+void CubeBatch::init() {
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    glGenBuffers(1, &meshVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, meshVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(CUBE_VERTICES), CUBE_VERTICES, GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *) 0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *) (3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *) (4 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    ensureCapacity(1);
+
+    shaderProgram = glCreateProgram();
+    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, 1, &VERTEX_SHADER, NULL);
+    glCompileShader(vertexShader);
+    checkShaderCompileErrors(vertexShader, "VERTEX");
+
+    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragmentShader, 1, &FRAGMENT_SHADER, NULL);
+    glCompileShader(fragmentShader);
+    checkShaderCompileErrors(fragmentShader, "FRAGMENT");
+
+    glAttachShader(shaderProgram, vertexShader);
+    glAttachShader(shaderProgram, fragmentShader);
+
+    glLinkProgram(shaderProgram);
+    int success;
+    char infoLog[512];
+    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+
+    if (!success) {
+        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED" << std::endl << infoLog << std::endl;
+        exit(-1);
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    glUseProgram(shaderProgram);
+    viewProjUniform = glGetUniformLocation(shaderProgram, "viewProj");
+    for (int i = 0; i < 7; i++) {
+        std::string uniformName = "colors[" + std::to_string(i) + "]";
+        colorSchemeUniforms[i] = glGetUniformLocation(shaderProgram, uniformName.c_str());
+    }
+}
+
+void CubeBatch::shutdown() {
+    glDeleteProgram(shaderProgram);
+    glDeleteBuffers(1, &meshVBO);
+    glDeleteBuffers(1, &cubitVBO);
+    glDeleteBuffers(1, &cubeVBO);
+    glDeleteVertexArrays(1, &vao);
+
+    capacity = 0;
+}
+
+void CubeBatch::checkShaderCompileErrors(GLuint shader, const char* type) {
+    int success;
+    char infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::" << type << "::COMPILATION_FAILED" << std::endl;
+        std::cout << infoLog << std::endl;
+        exit(-1);
+    }
+}
+
+void CubeBatch::buildCubits(const RubiksCube& cube, int turningSide, CubitInstance* out) {
+    int n = 0;
+
+    for (int i = 0; i < 8; i++) {
+        Corner corner = (Corner) i;
+        CornerData cornerData = cube.getCorner(corner);
+        CubitInstance& cubit = out[n++];
+
+        std::fill(cubit.sides, cubit.sides + 6, 6);
+        cubit.sides[CORNER_UD[corner]] = cornerData.ud;
+        cubit.sides[CORNER_LR[corner]] = cornerData.lr;
+        cubit.sides[CORNER_FB[corner]] = cornerData.fb;
+
+        cubit.offset = SIDE_NORMALS[CORNER_UD[corner]] + SIDE_NORMALS[CORNER_LR[corner]] + SIDE_NORMALS[CORNER_FB[corner]];
+        cubit.turning = turningSide != -1 && CORNER_IS_IN_SIDE[corner][turningSide];
+    }
+
+    for (int i = 0; i < 12; i++) {
+        Edge edge = (Edge) i;
+        EdgeData edgeData = cube.getEdge(edge);
+        EdgeData pos = fromEdge(edge);
+        CubitInstance& cubit = out[n++];
+
+        std::fill(cubit.sides, cubit.sides + 6, 6);
+        cubit.sides[pos.a] = edgeData.a;
+        cubit.sides[pos.b] = edgeData.b;
+
+        cubit.offset = SIDE_NORMALS[pos.a] + SIDE_NORMALS[pos.b];
+        cubit.turning = turningSide != -1 && EDGE_IS_IN_SIDE[edge][turningSide];
+    }
+
+    for (int i = 0; i < 6; i++) {
+        CubitInstance& cubit = out[n++];
+
+        std::fill(cubit.sides, cubit.sides + 6, 6);
+        cubit.sides[i] = i;
+
+        cubit.offset = SIDE_NORMALS[i];
+        cubit.turning = turningSide == i;
+    }
+}
+
+glm::vec4 CubeBatch::getSpin(Move move, float t) {
+    float targetAngle;
+    switch (move.moveType) {
+        case MoveType::CLOCKWISE:
+            targetAngle = 90.0f;
+            break;
+        case MoveType::COUNTERCLOCKWISE:
+            targetAngle = -90.0f;
+            break;
+        case MoveType::DOUBLE_TURN:
+            targetAngle = 180.0f;
+            break;
+    }
+
+    float angle = glm::mix(0.0f, targetAngle, t);
+
+    return glm::vec4(SIDE_NORMALS[move.side], -glm::radians(angle));
+}
+
+void CubeBatch::ensureCapacity(int numCubes) {
+    if (numCubes <= capacity) return;
+
+    int newCapacity = std::max(numCubes, capacity * 2);
+
+    //Copy whatever is already uploaded into the bigger buffers
+    GLuint buffers[2];
+    glGenBuffers(2, buffers);
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) (newCapacity * CUBITS_PER_CUBE * sizeof(CubitInstance)), nullptr, GL_DYNAMIC_DRAW);
+    //Cubes nobody has placed yet sit at the origin at full size, not shrunk to a point by whatever the driver left there
+    std::vector<CubeInstance> defaultCubes(newCapacity);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) (newCapacity * sizeof(CubeInstance)), defaultCubes.data(), GL_DYNAMIC_DRAW);
+
+    if (capacity) {
+        glBindBuffer(GL_COPY_READ_BUFFER, cubitVBO);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[0]);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr) (capacity * CUBITS_PER_CUBE * sizeof(CubitInstance)));
+
+        glBindBuffer(GL_COPY_READ_BUFFER, cubeVBO);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[1]);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr) (capacity * sizeof(CubeInstance)));
+
+        glDeleteBuffers(1, &cubitVBO);
+        glDeleteBuffers(1, &cubeVBO);
+    }
+
+    cubitVBO = buffers[0];
+    cubeVBO = buffers[1];
+    capacity = newCapacity;
+
+    bindInstanceAttributes();
+}
+
+void CubeBatch::bindInstanceAttributes() {
+    glBindVertexArray(vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, cubitVBO);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(CubitInstance), (void *) offsetof(CubitInstance, offset));
+    glVertexAttribIPointer(4, 3, GL_INT, sizeof(CubitInstance), (void *) offsetof(CubitInstance, sides));
+    glVertexAttribIPointer(5, 3, GL_INT, sizeof(CubitInstance), (void *) (offsetof(CubitInstance, sides) + 3 * sizeof(int32_t)));
+    glVertexAttribPointer(6, 1, GL_FLOAT, GL_FALSE, sizeof(CubitInstance), (void *) offsetof(CubitInstance, turning));
+
+    for (int i = 3; i <= 6; i++) {
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 1);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+    glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(CubeInstance), (void *) offsetof(CubeInstance, placement));
+    glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, sizeof(CubeInstance), (void *) offsetof(CubeInstance, spin));
+
+    for (int i = 7; i <= 8; i++) {
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, CUBITS_PER_CUBE);
+    }
+}
+
+void CubeBatch::setCubits(const CubitInstance* cubits, int numCubes, int firstCube) {
+    ensureCapacity(firstCube + numCubes);
+
+    glBindBuffer(GL_ARRAY_BUFFER, cubitVBO);
+    glBufferSubData(GL_ARRAY_BUFFER, (GLintptr) (firstCube * CUBITS_PER_CUBE * sizeof(CubitInstance)), (GLsizeiptr) (numCubes * CUBITS_PER_CUBE * sizeof(CubitInstance)), cubits);
+}
+
+void CubeBatch::setCubes(const CubeInstance* cubes, int numCubes, int firstCube) {
+    ensureCapacity(firstCube + numCubes);
+
+    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+    glBufferSubData(GL_ARRAY_BUFFER, (GLintptr) (firstCube * sizeof(CubeInstance)), (GLsizeiptr) (numCubes * sizeof(CubeInstance)), cubes);
+}
+
+void CubeBatch::setColorScheme(const Color colors[7]) {
+    glUseProgram(shaderProgram);
+
+    for (int i = 0; i < 7; i++) {
+        glm::vec3 color;
+
+        color.r = colors[i].r / 255.0f;
+        color.g = colors[i].g / 255.0f;
+        color.b = colors[i].b / 255.0f;
+
+        glUniform3fv(colorSchemeUniforms[i], 1, glm::value_ptr(color));
+    }
+}
+
+void CubeBatch::draw(const glm::mat4& viewProj, int numCubes) {
+    if (numCubes <= 0) return;
+
+    glUseProgram(shaderProgram);
+    glBindVertexArray(vao);
+    glUniformMatrix4fv(viewProjUniform, 1, GL_FALSE, glm::value_ptr(viewProj));
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 36, numCubes * CUBITS_PER_CUBE);
+}
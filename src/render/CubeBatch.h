@@ -0,0 +1,79 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_CUBEBATCH_H
+#define RUBIK_CUBEBATCH_H
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include "src/cube/RubiksCube.h"
+#include "CubeScanner.h"
+
+#include <vector>
+
+const int CUBITS_PER_CUBE = 26;
+
+//One of the 26 visible pieces of a cube
+struct CubitInstance {
+    //Center of the cubit, relative to the center of the cube
+    glm::vec3 offset;
+    //Color shown on each face of the cubit, 6 for the inside
+    int32_t sides[6];
+    //1 if the cubit is in the face that is currently turning
+    float turning;
+};
+
+struct CubeInstance {
+    //Position of the cube in the world (xyz) and its scale (w)
+    glm::vec4 placement = {0, 0, 0, 1};
+    //Axis (xyz) and angle in radians (w) the turning face is rotated by
+    glm::vec4 spin = {0, 1, 0, 0};
+};
+
+/*
+ * Draws any number of cubes with a single glDrawArraysInstanced. Every cubit is an instance of the same 36 vertex
+ * mesh, the cubit buffer holds what each cubit looks like and the cube buffer, which advances once every 26 instances,
+ * where each cube is and how far its turning face has rotated. The rotation happens in the vertex shader, so an
+ * animated turn only changes the small cube buffer, the cubits only change when the cube itself or the face being
+ * turned does.
+ */
+class CubeBatch {
+public:
+    //Needs a current OpenGL context
+    void init();
+    void shutdown();
+
+    //The 26 cubits of cube, turningSide is -1 if no face is turning
+    static void buildCubits(const RubiksCube& cube, int turningSide, CubitInstance* out);
+    //Rotation of the turning face after fraction t (already eased) of move
+    static glm::vec4 getSpin(Move move, float t);
+
+    //Both take CUBITS_PER_CUBE cubits per cube, and grow the buffers when needed
+    void setCubits(const CubitInstance* cubits, int numCubes, int firstCube = 0);
+    void setCubes(const CubeInstance* cubes, int numCubes, int firstCube = 0);
+
+    void setColorScheme(const Color colors[7]);
+
+    void draw(const glm::mat4& viewProj, int numCubes);
+
+private:
+    GLuint vao = 0;
+    GLuint meshVBO = 0;
+    GLuint cubitVBO = 0;
+    GLuint cubeVBO = 0;
+
+    //In cubes
+    int capacity = 0;
+
+    GLuint shaderProgram = 0;
+    GLint viewProjUniform;
+    GLint colorSchemeUniforms[7];
+
+    void ensureCapacity(int numCubes);
+    void bindInstanceAttributes();
+
+    static void checkShaderCompileErrors(GLuint shader, const char* type);
+};
+
+#endif //RUBIK_CUBEBATCH_H
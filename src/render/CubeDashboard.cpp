@@ -0,0 +1,170 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#include "CubeDashboard.h"
+
+#include <cmath>
+
+//Covers a cube of side 3 and its turning faces
+static const float CUBE_BOUNDING_RADIUS = 1.5f * std::sqrt(3.0f);
+
+void CubeDashboard::init() {
+    batch.init();
+}
+
+void CubeDashboard::shutdown() {
+    batch.shutdown();
+}
+
+int CubeDashboard::addCube(const RubiksCube& cube) {
+    cubes.emplace_back();
+    cubes.back().cube = cube;
+
+    return (int) cubes.size() - 1;
+}
+
+void CubeDashboard::resize(int numCubes) {
+    cubes.resize(numCubes);
+}
+
+void CubeDashboard::clear() {
+    cubes.clear();
+    visible.clear();
+}
+
+void CubeDashboard::setCube(int index, const RubiksCube& cube) {
+    DashboardCube& entry = cubes[index];
+
+    entry.cube = cube;
+    entry.moveQueue = {};
+    entry.isMoving = false;
+    entry.cubitsDirty = true;
+}
+
+void CubeDashboard::pushMoves(int index, const std::vector<Move>& moves) {
+    for (Move move: moves) {
+        cubes[index].moveQueue.push(move);
+    }
+}
+
+bool CubeDashboard::isIdle(int index) const {
+    return !cubes[index].isMoving && cubes[index].moveQueue.empty();
+}
+
+glm::vec3 CubeDashboard::getPosition(int index) const {
+    int columns = (int) std::ceil(std::sqrt((float) cubes.size()));
+    int rows = ((int) cubes.size() + columns - 1) / columns;
+
+    int column = index % columns;
+    int row = index / columns;
+
+    return center + glm::vec3((column - (columns - 1) / 2.0f) * spacing, ((rows - 1) / 2.0f - row) * spacing, 0);
+}
+
+void CubeDashboard::update(double time) {
+    for (DashboardCube& entry: cubes) {
+        if (entry.isMoving && time >= entry.turnStartTime + entry.duration) {
+            entry.cube.doMove(entry.currentMove);
+            entry.isMoving = false;
+            entry.cubitsDirty = true;
+        }
+
+        if (!entry.isMoving && !entry.moveQueue.empty()) {
+            entry.currentMove = entry.moveQueue.front();
+            entry.moveQueue.pop();
+
+            entry.isMoving = true;
+            entry.turnStartTime = time;
+            entry.duration = entry.currentMove.moveType == DOUBLE_TURN ? turnDuration * 2 : turnDuration;
+            entry.cubitsDirty = true;
+        }
+
+        if (entry.isMoving) {
+            float t = (float) ((time - entry.turnStartTime) / entry.duration);
+            entry.instance.spin = CubeBatch::getSpin(entry.currentMove, easingFunction(t));
+        } else {
+            entry.instance.spin = CubeInstance().spin;
+        }
+    }
+}
+
+void CubeDashboard::render(const glm::mat4& viewProj) {
+    //Frustum planes from the rows of the matrix (Gribb & Hartmann), pointing inwards
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++) {
+        rows[i] = glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+    }
+
+    glm::vec4 planes[6] = {
+            rows[3] + rows[0], rows[3] - rows[0],
+            rows[3] + rows[1], rows[3] - rows[1],
+            rows[3] + rows[2], rows[3] - rows[2]
+    };
+
+    std::vector<int> nextVisible;
+    nextVisible.reserve(cubes.size());
+
+    for (int i = 0; i < (int) cubes.size(); i++) {
+        glm::vec3 position = getPosition(i);
+        cubes[i].instance.placement = glm::vec4(position, 1);
+
+        bool inside = true;
+        for (const glm::vec4& plane: planes) {
+            glm::vec3 normal(plane.x, plane.y, plane.z);
+
+            if (glm::dot(normal, position) + plane.w < -CUBE_BOUNDING_RADIUS * std::sqrt(glm::dot(normal, normal))) {
+                inside = false;
+                break;
+            }
+        }
+
+        if (inside) {
+            nextVisible.push_back(i);
+        }
+    }
+
+    //When a different set of cubes is visible all of the slots move, otherwise only cubes that changed are uploaded
+    bool reordered = nextVisible != visible;
+    visible = std::move(nextVisible);
+
+    std::vector<CubitInstance> allCubits;
+    if (reordered) {
+        allCubits.resize(visible.size() * CUBITS_PER_CUBE);
+    }
+
+    std::vector<CubeInstance> instances(visible.size());
+
+    for (int slot = 0; slot < (int) visible.size(); slot++) {
+        DashboardCube& entry = cubes[visible[slot]];
+
+        if (entry.cubitsDirty) {
+            CubeBatch::buildCubits(entry.cube, entry.isMoving ? entry.currentMove.side : -1, entry.cubits);
+            entry.cubitsDirty = false;
+
+            if (!reordered) {
+                batch.setCubits(entry.cubits, 1, slot);
+            }
+        }
+
+        if (reordered) {
+            std::copy(entry.cubits, entry.cubits + CUBITS_PER_CUBE, allCubits.begin() + slot * CUBITS_PER_CUBE);
+        }
+
+        instances[slot] = entry.instance;
+    }
+
+    if (reordered && !visible.empty()) {
+        batch.setCubits(allCubits.data(), (int) visible.size());
+    }
+
+    if (!visible.empty()) {
+        batch.setCubes(instances.data(), (int) visible.size());
+    }
+
+    batch.draw(viewProj, (int) visible.size());
+}
+
+void CubeDashboard::setColorScheme(const Color colors[7]) {
+    batch.setColorScheme(colors);
+}
@@ -0,0 +1,79 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_CUBEDASHBOARD_H
+#define RUBIK_CUBEDASHBOARD_H
+
+#include "CubeBatch.h"
+#include "src/util/easing.h"
+
+#include <queue>
+#include <vector>
+
+/*
+ * A grid of independently animated cubes, for watching many robots or simulated solves at once. Each cube has its own
+ * move queue and turn animation. Everything is drawn through one CubeBatch: the cubes outside the view frustum are left
+ * out, the rest are packed together and drawn with a single instanced call. Turning only changes a cube's spin, so most
+ * frames upload 32 bytes per visible cube, the cubits of a cube are only rebuilt when it starts or finishes a turn.
+ */
+class CubeDashboard {
+public:
+    //The grid is centered on this point, facing +z
+    glm::vec3 center = {0, 0, -10};
+    //Distance between the centers of neighbouring cubes
+    float spacing = 4.5f;
+    float turnDuration = 0.5f;
+    float (*easingFunction)(float) = easeInOutBack;
+
+    //Needs a current OpenGL context
+    void init();
+    void shutdown();
+
+    int addCube(const RubiksCube& cube = RubiksCube());
+    void resize(int numCubes);
+    void clear();
+
+    [[nodiscard]] int size() const {
+        return (int) cubes.size();
+    }
+
+    void setCube(int index, const RubiksCube& cube);
+    void pushMoves(int index, const std::vector<Move>& moves);
+    [[nodiscard]] bool isIdle(int index) const;
+
+    void update(double time);
+    void render(const glm::mat4& viewProj);
+
+    void setColorScheme(const Color colors[7]);
+
+    //Cubes drawn by the last render
+    [[nodiscard]] int getVisibleCount() const {
+        return (int) visible.size();
+    }
+
+private:
+    struct DashboardCube {
+        RubiksCube cube;
+        std::queue<Move> moveQueue;
+
+        bool isMoving = false;
+        Move currentMove;
+        double turnStartTime = 0;
+        double duration = 0;
+
+        CubeInstance instance;
+        CubitInstance cubits[CUBITS_PER_CUBE];
+        bool cubitsDirty = true;
+    };
+
+    CubeBatch batch;
+    std::vector<DashboardCube> cubes;
+
+    //Index of the cube in each slot of the batch, from the last render
+    std::vector<int> visible;
+
+    glm::vec3 getPosition(int index) const;
+};
+
+#endif //RUBIK_CUBEDASHBOARD_H
@@ -12,12 +12,16 @@
 #include "GLFW/glfw3.h"
 #include "lib/glm/glm/glm.hpp"
 #include "lib/glm/glm/matrix.hpp"
+#include <algorithm>
 #include <map>
 #include <random>
 #include <cmath>
+#include <cstdio>
+#include <sstream>
 #include "src/util/easing.h"
 #include "src/util/RedundantMovePreventor.h"
 #include "src/cube/FastRubiksCube.h"
+#include "src/cube/CubeKernels.h"
 #include "src/cube/solve/solver.h"
 #include "src/cube/solve/kociemba.h"
 
@@ -35,115 +39,8 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
     windowToRenderer[window]->onKeyPress(key, scancode, action, mods);
 }
 
-/*
- * To render the cube, we will render it as its 26 separate cubies in 26 passes because I can't be bothered to do it any other way.
-*/
-
-const char * VERTEX_SHADER = R"(
-#version 330 core
-
-layout (location = 0) in vec3 pos;
-layout (location = 1) in float side;
-layout (location = 2) in vec2 uv;
-
-uniform mat4 projViewModel;
-uniform int sides[6];
-
-out vec3 color;
-out vec2 texCoord;
-
-//DEFINE COLORS FR
-uniform vec3 colors[7] = vec3[](
-    vec3(1.0, 0.0, 0.0), //RED (FRONT)
-    vec3(1.0, 0.647, 0.0), //ORANGE (BACK)
-    vec3(0.0, 0.0, 1.0), //BLUE (LEFT)
-    vec3(0.0, 1.0, 0.0), //GREEN (RIGHT)
-    vec3(1.0, 1.0, 0.0), //YELLOW (TOP)
-    vec3(1.0, 1.0, 1.0), //WHITE (BOTTOM)
-    vec3(0.0, 0.0, 0.0) //BLACK (OUTSIDE)
-);
-
-void main() {
-    gl_Position = projViewModel * vec4(pos, 1.0);
-    color = colors[sides[int(side)]];
-    texCoord = uv;
-}
-)";
-
-const char * FRAGMENT_SHADER = R"(
-#version 330 core
-
-in vec3 color;
-in vec2 texCoord;
-
-out vec4 fragColor;
-
-uniform vec3 colors[7];
-
-void main() {
-    //float additional = 0.9 + 0.1 * sin(texCoord.x * 100.0 + texCoord.y * 100.0);
-    float additional = 1.0;
-    fragColor = vec4(additional * color, 1.0);
-
-    if (texCoord.x < 0.05 || texCoord.x > 0.95 || texCoord.y < 0.05 || texCoord.y > 0.95) {
-        fragColor = vec4(additional * colors[6], 1.0);
-    }
-}
-)";
-
-
 bool gladInitialized = false;
 
-const float CUBE_VERTICES[] = {
-        //FRONT (0)
-        -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 0.0f,
-        0.5f, -0.5f, 0.5f, 0.0f, 1.0f, 0.0f,
-        0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 1.0f,
-        0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 1.0f,
-        -0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f,
-        -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 0.0f,
-
-        //BACK (1)
-        0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f,
-        -0.5f, -0.5f, -0.5f, 1.0f, 1.0f, 0.0f,
-        0.5f, 0.5f, -0.5f, 1.0f, 0.0f, 1.0f,
-        -0.5f, 0.5f, -0.5f, 1.0f, 1.0f, 1.0f,
-        0.5f, 0.5f, -0.5f, 1.0f, 0.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f, 1.0f, 1.0f, 0.0f,
-
-        //LEFT (2)
-        -0.5f, -0.5f, -0.5f, 2.0f, 0.0f, 0.0f,
-        -0.5f, -0.5f, 0.5f, 2.0f, 1.0f, 0.0f,
-        -0.5f, 0.5f, -0.5f, 2.0f, 0.0f, 1.0f,
-        -0.5f, 0.5f, 0.5f, 2.0f, 1.0f, 1.0f,
-        -0.5f, 0.5f, -0.5f, 2.0f, 0.0f, 1.0f,
-        -0.5f, -0.5f, 0.5f, 2.0f, 1.0f, 0.0f,
-
-        //RIGHT (3)
-        0.5f, -0.5f, 0.5f, 3.0f, 0.0f, 0.0f,
-        0.5f, -0.5f, -0.5f, 3.0f, 1.0f, 0.0f,
-        0.5f, 0.5f, -0.5f, 3.0f, 1.0f, 1.0f,
-        0.5f, 0.5f, -0.5f, 3.0f, 1.0f, 1.0f,
-        0.5f, 0.5f, 0.5f, 3.0f, 0.0f, 1.0f,
-        0.5f, -0.5f, 0.5f, 3.0f, 0.0f, 0.0f,
-
-        //TOP (4)
-        -0.5f, 0.5f, 0.5f, 4.0f, 0.0f, 0.0f,
-        0.5f, 0.5f, 0.5f, 4.0f, 1.0f, 0.0f,
-        0.5f, 0.5f, -0.5f, 4.0f, 1.0f, 1.0f,
-        0.5f, 0.5f, -0.5f, 4.0f, 1.0f, 1.0f,
-        -0.5f, 0.5f, -0.5f, 4.0f, 0.0f, 1.0f,
-        -0.5f, 0.5f, 0.5f, 4.0f, 0.0f, 0.0f,
-
-        //BOTTOM (5)
-        0.5f, -0.5f, 0.5f, 5.0f, 0.0f, 0.0f,
-        -0.5f, -0.5f, 0.5f, 5.0f, 1.0f, 0.0f,
-        0.5f, -0.5f, -0.5f, 5.0f, 0.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f, 5.0f, 1.0f, 1.0f,
-        0.5f, -0.5f, -0.5f, 5.0f, 0.0f, 1.0f,
-        -0.5f, -0.5f, 0.5f, 5.0f, 1.0f, 0.0f
-};
-
 CubeRenderer::CubeRenderer()
     :
         cube(),
@@ -153,7 +50,7 @@ CubeRenderer::CubeRenderer()
     cameraMode = true;
     initGL();
 
-    memcpy_s(this->robotIpField, sizeof(this->robotIpField), robot.getIp().c_str(), robot.getIp().size() + 1);
+    snprintf(this->robotIpField, sizeof(this->robotIpField), "%s", robot.getIp().c_str());
 }
 
 CubeRenderer::~CubeRenderer() {
@@ -193,59 +90,9 @@ void CubeRenderer::initGL() {
         gladInitialized = true;
     }
 
-    //Create VAO
-    glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
-
-    //Create VBO
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(CUBE_VERTICES), CUBE_VERTICES, GL_STATIC_DRAW);
-
-    //Define vertex attributes
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *) 0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *) (3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *) (4 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    //Create program
-    shaderProgram = glCreateProgram();
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &VERTEX_SHADER, NULL);
-    glCompileShader(vertexShader);
-    checkShaderCompileErrors(vertexShader, "VERTEX");
-
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &FRAGMENT_SHADER, NULL);
-    glCompileShader(fragmentShader);
-    checkShaderCompileErrors(fragmentShader, "FRAGMENT");
-
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-
-    glLinkProgram(shaderProgram);
-    int success;
-    char infoLog[512];
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-
-    if (!success) {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED" << std::endl << infoLog << std::endl;
-        exit(-1);
-    }
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    glUseProgram(shaderProgram);
-    sidesUniform = glGetUniformLocation(shaderProgram, "sides");
-    transformUniform = glGetUniformLocation(shaderProgram, "projViewModel");
-    for (int i = 0; i < 7; i++) {
-        std::string uniformName = "colors[" + std::to_string(i) + "]";
-        colorSchemeUniforms[i] = glGetUniformLocation(shaderProgram, uniformName.c_str());
-    }
+    cubeBatch.init();
+    dashboard.init();
+    dashboard.resize(dashboardSize);
 
     uploadColorScheme();
 
@@ -270,22 +117,9 @@ void CubeRenderer::initGL() {
     ImGui_ImplOpenGL3_Init("#version 330");
 }
 
-void CubeRenderer::checkShaderCompileErrors(GLuint shader, const char *string) {
-    int success;
-    char infoLog[512];
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(shader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::" << string << "::COMPILATION_FAILED" << std::endl;
-        std::cout << infoLog << std::endl;
-        exit(-1);
-    }
-}
-
 void CubeRenderer::shutdownGL() {
-    glDeleteProgram(shaderProgram);
-    glDeleteBuffers(1, &vbo);
-    glDeleteVertexArrays(1, &vao);
+    cubeBatch.shutdown();
+    dashboard.shutdown();
     glfwTerminate();
 
     windowToRenderer.erase(window);
@@ -326,58 +160,65 @@ void CubeRenderer::processInput(double dt, double currTime) {
 void CubeRenderer::render(double dt, double currTime) {
     glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glUseProgram(shaderProgram);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
 
-    for (int i = 0; i < 3; i++) {
-        glEnableVertexAttribArray(i);
+    if (showDashboard) {
+        renderDashboard(currTime);
+        return;
     }
 
-    Side currSpin = (Side) -1;
-    glm::mat4 transform = glm::mat4(1.0f);
+    int turningSide = isMoving ? currentMove.side : -1;
 
-    if (isMoving) {
-        currSpin = currentMove.side;
-        float targetAngle;
-        switch (currentMove.moveType) {
-            case MoveType::CLOCKWISE:
-                targetAngle = 90.0f;
-                break;
-            case MoveType::COUNTERCLOCKWISE:
-                targetAngle = -90.0f;
-                break;
-            case MoveType::DOUBLE_TURN:
-                targetAngle = 180.0f;
-                break;
-        }
+    //The cubits only change when the cube does or a different face starts turning
+    if (turningSide != uploadedTurningSide || cube != uploadedCube) {
+        CubitInstance cubits[CUBITS_PER_CUBE];
+        CubeBatch::buildCubits(cube, turningSide, cubits);
+        cubeBatch.setCubits(cubits, 1);
 
-        glm::vec3 axis = SIDE_NORMALS[currSpin];
+        uploadedCube = cube;
+        uploadedTurningSide = turningSide;
+    }
 
+    if (isMoving) {
         float t = (float) (currTime - turnStartTime) / (float) turnDuration;
         t = easingFunction(t);
 
-        float angle = glm::mix(0.0f, targetAngle, t);
-
-        transform = glm::rotate(transform, -glm::radians(angle)/* * (axis.x + axis.y + axis.z)*/, axis);
+        CubeInstance instance;
+        instance.spin = CubeBatch::getSpin(currentMove, t);
+        cubeBatch.setCubes(&instance, 1);
+        spinUploaded = true;
+    } else if (spinUploaded) {
+        CubeInstance instance;
+        cubeBatch.setCubes(&instance, 1);
+        spinUploaded = false;
     }
 
     glm::mat4 view = this->camera.getViewMatrix();
     glm::mat4 projection = glm::perspective(glm::radians(80.f), (float) width / (float) height, 0.1f, 100.0f);
 
-    glm::mat4 combined = projection * view;
+    cubeBatch.draw(projection * view, 1);
+}
 
-    for (int i = 0; i < 8; i++) {
-        renderCorner((Corner) i, combined, currSpin, transform);
-    }
+void CubeRenderer::renderDashboard(double currTime) {
+    dashboard.turnDuration = 0.5f / (float) pow(2, turnSpeed);
+    dashboard.easingFunction = easingFunction;
 
-    for (int i = 0; i < 12; i++) {
-        renderEdge((Edge) i, combined, currSpin, transform);
-    }
+    //Keep every idle cube busy with random moves, a stand-in until the cubes are fed by robots and solvers
+    if (dashboardRandomMoves) {
+        std::uniform_int_distribution<> dis(0, 17);
 
-    for (int i = 0; i < 6; i++) {
-        renderCenter((Side) i, combined, currSpin, transform);
+        for (int i = 0; i < dashboard.size(); i++) {
+            if (dashboard.isIdle(i)) {
+                dashboard.pushMoves(i, {ALL_MOVES[dis(dashboardRandom)]});
+            }
+        }
     }
+
+    dashboard.update(currTime);
+
+    glm::mat4 view = this->camera.getViewMatrix();
+    glm::mat4 projection = glm::perspective(glm::radians(80.f), (float) width / (float) height, 0.1f, 1000.0f);
+
+    dashboard.render(projection * view);
 }
 
 void CubeRenderer::renderImGui() {
@@ -456,7 +297,7 @@ void CubeRenderer::renderImGui() {
 
 
     ImGui::Text("Cube Info");
-    ImGui::BeginChild("Cube Info", ImVec2(0, 100), true);
+    ImGui::BeginChild("Cube Info", ImVec2(0, 120), true);
 
     FastRubiksCube cube(this->cube);
     if (cube.isValid()) {
@@ -475,11 +316,15 @@ void CubeRenderer::renderImGui() {
         ImGui::Text("Cube is not valid");
     }
 
+    ImGui::Text("Kernels: %s", describeCubeKernels().c_str());
+
     ImGui::EndChild();
 
     ImGui::Text("Cube Solver");
     ImGui::BeginChild("Cube Solver", ImVec2(0, 120), true);
 
+    this->pollSolver();
+
     if (ImGui::Button("Solve")) {
         this->flushMoves();
         this->launchSolver();
@@ -492,11 +337,10 @@ void CubeRenderer::renderImGui() {
         }
     }
 
-    solverMutex.lock();
-
     if (solverState == SolverState::OFF) {
         ImGui::Text("Solver is off");
     } else if (solverState == SolverState::RUNNING) {
+        std::string solverStatusMessage = solverService.getStatus(solverJob->jobId);
         if (solverStatusMessage.size()) {
             ImGui::Text("Solver is running (%s)", solverStatusMessage.c_str());
         } else {
@@ -522,17 +366,35 @@ void CubeRenderer::renderImGui() {
         }
     }
 
-    solverMutex.unlock();
+    ImGui::EndChild();
 
+    ImGui::Text("Dashboard");
+    ImGui::BeginChild("Dashboard", ImVec2(0, 80), true);
+    ImGui::Checkbox("Show dashboard", &this->showDashboard);
+    ImGui::SameLine();
+    ImGui::Checkbox("Random moves", &this->dashboardRandomMoves);
+
+    if (ImGui::SliderInt("Cubes", &this->dashboardSize, 1, 1000)) {
+        dashboard.resize(dashboardSize);
+    }
+
+    ImGui::Text("Drawing %d/%d cubes at %.1f FPS", dashboard.getVisibleCount(), dashboard.size(), ImGui::GetIO().Framerate);
     ImGui::EndChild();
 
     if (ImGui::Button("Scan cube") && !scanner) {
-        scanner = std::move(CubeScanner());
+        scanner.emplace();
     }
 
     if (robot.isActive()) {
         ImGui::Text("Connected to robot on %s!", robot.getIp().c_str());
 
+        if (connectedRobots.size() > 1) {
+            ImGui::Text("The cube follows");
+            for (const RobotInfo& info: connectedRobots) {
+                ImGui::RadioButton(info.address.c_str(), &this->followedRobot, info.id);
+            }
+        }
+
         if (ImGui::Button("Reset")) {
             robot.resetRobot();
         }
@@ -561,8 +423,20 @@ void CubeRenderer::mainLoop() {
         robot.tick();
 
         while (!robot.movesExecuted.empty()) {
-            moveQueue.push(robot.movesExecuted.front());
+            RobotMove executed = robot.movesExecuted.front();
             robot.movesExecuted.pop();
+
+            if (followedRobot == -1) followedRobot = executed.robot;
+            if (executed.robot == followedRobot) moveQueue.push(executed.move);
+        }
+
+        //Once the followed robot is gone, the oldest one left takes over
+        connectedRobots = robot.getRobots();
+        bool followedConnected = std::any_of(connectedRobots.begin(), connectedRobots.end(), [&](const RobotInfo& info) {
+            return info.id == followedRobot;
+        });
+        if (!followedConnected) {
+            followedRobot = connectedRobots.empty() ? -1 : connectedRobots[0].id;
         }
 
         double currentFrameTime = glfwGetTime();
@@ -596,73 +470,6 @@ void CubeRenderer::mainLoop() {
     }
 }
 
-void CubeRenderer::renderCubit(glm::mat4 model, glm::mat4 viewProj, int sides[6]) const {
-    glUniform1iv(sidesUniform, 6, sides);
-    glUniformMatrix4fv(transformUniform, 1, GL_FALSE, glm::value_ptr(viewProj * model));
-    glDrawArrays(GL_TRIANGLES, 0, 36);
-}
-
-void CubeRenderer::renderCorner(Corner corner, glm::mat4 viewModel, Side currSpin, glm::mat4 spinTransform) {
-    int sides[6] = { 6, 6, 6, 6, 6, 6 };
-    CornerData cornerData = cube.getCorner(corner);
-
-    glm::vec3 translate = { 0.0f, 0.0f, 0.0f };
-
-    sides[CORNER_UD[corner]] = cornerData.ud;
-    sides[CORNER_LR[corner]] = cornerData.lr;
-    sides[CORNER_FB[corner]] = cornerData.fb;
-
-    translate += SIDE_NORMALS[CORNER_UD[corner]];
-    translate += SIDE_NORMALS[CORNER_LR[corner]];
-    translate += SIDE_NORMALS[CORNER_FB[corner]];
-
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, translate);
-
-    if (CORNER_IS_IN_SIDE[corner][currSpin]) {
-        model = spinTransform * model;
-    }
-
-    renderCubit(model, viewModel, sides);
-}
-
-void CubeRenderer::renderEdge(Edge edge, glm::mat4 viewModel, Side currSpin, glm::mat4 spinTransform) {
-    int sides[6] = { 6, 6, 6, 6, 6, 6 };
-    EdgeData edgeData = cube.getEdge(edge);
-    EdgeData pos = fromEdge(edge);
-
-    glm::vec3 translate = { 0.0f, 0.0f, 0.0f };
-
-    sides[pos.a] = edgeData.a;
-    sides[pos.b] = edgeData.b;
-
-    translate += SIDE_NORMALS[pos.a];
-    translate += SIDE_NORMALS[pos.b];
-
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, translate);
-
-    if (EDGE_IS_IN_SIDE[edge][currSpin]) {
-        model = spinTransform * model;
-    }
-
-    renderCubit(model, viewModel, sides);
-}
-
-void CubeRenderer::renderCenter(Side side, glm::mat4 viewModel, Side currSpin, glm::mat4 spinTransform) const {
-    int sides[6] = { 6, 6, 6, 6, 6, 6 };
-    sides[side] = side;
-
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, SIDE_NORMALS[side]);
-
-    if (currSpin == side) {
-        model = spinTransform * model;
-    }
-
-    renderCubit(model, viewModel, sides);
-}
-
 void CubeRenderer::toggleCameraMode() {
     cameraMode = !cameraMode;
     if (cameraMode) {
@@ -800,15 +607,8 @@ void CubeRenderer::setCube(RubiksCube cube) {
 }
 
 void CubeRenderer::uploadColorScheme() {
-    for (int i = 0; i < 7; i++) {
-        glm::vec3 color;
-
-        color.r = this->colorScheme[i].r / 255.0f;
-        color.g = this->colorScheme[i].g / 255.0f;
-        color.b = this->colorScheme[i].b / 255.0f;
-
-        glUniform3fv(colorSchemeUniforms[i], 1, glm::value_ptr(color));
-    }
+    cubeBatch.setColorScheme(colorScheme);
+    dashboard.setColorScheme(colorScheme);
 }
 
 void CubeRenderer::pushAllMoves(std::vector<Move> moves) {
@@ -843,40 +643,34 @@ void CubeRenderer::launchSolver() {
 
     this->solverState = SolverState::RUNNING;
     this->solverResult = std::nullopt;
-    this->haltSolver = false;
 
-    this->solverThread.reset();
-    this->solverStatusMessage = "";
+    SolveBudget budget;
+    //Only worth trading moves for robot time when the robot is going to do them
+    budget.costModel = robot.isActive() ? &this->robotCostModel : nullptr;
 
-    auto updateStatus = [this](std::string msg) {
-        this->solverMutex.lock();
-        this->solverStatusMessage = msg;
-        this->solverMutex.unlock();
-    };
-
-    this->solverThread = std::thread([this, updateStatus]() {
-        auto start = std::chrono::high_resolution_clock::now();
-        auto optMoves = solve(FastRubiksCube(this->cube), this->haltSolver, updateStatus);
-        auto end = std::chrono::high_resolution_clock::now();
-
-        std::chrono::duration<double> elapsed = end - start;
-        std::cout << "Solved in " << elapsed.count() << "s" << std::endl;
-        this->timeTaken = elapsed;
-
-        this->solverState = SolverState::OFF;
-
-        this->solverMutex.lock();
-        this->solverResult = optMoves;
-        this->solverMutex.unlock();
-    });
-    this->solverThread->detach();
+    this->solverJob = solverService.submit(FastRubiksCube(this->cube), budget);
 }
 
 void CubeRenderer::stopSolver() {
-    if (this->solverState == SolverState::OFF) {
+    if (this->solverState != SolverState::RUNNING) {
         return;
     }
 
-    this->haltSolver = true;
+    solverService.cancel(this->solverJob->jobId);
     this->solverState = SolverState::STOPPING;
 }
+
+void CubeRenderer::pollSolver() {
+    if (!this->solverJob || !this->solverJob->isReady()) {
+        return;
+    }
+
+    const SolveResult& result = this->solverJob->result.get();
+    std::cout << "Solved in " << result.timeTaken.count() << "s" << std::endl;
+
+    this->solverResult = result.moves;
+    this->timeTaken = result.timeTaken;
+
+    this->solverJob.reset();
+    this->solverState = SolverState::OFF;
+}
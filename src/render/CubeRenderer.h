@@ -14,11 +14,16 @@
 #include "src/util/easing.h"
 #include "CubeScanner.h"
 #include "CuberConnection.h"
+#include "CubeBatch.h"
+#include "CubeDashboard.h"
+#include "src/cube/solve/move_cost.h"
+#include "src/cube/solve/solver_service.h"
 
 #include <queue>
 #include <mutex>
 #include <chrono>
 #include <thread>
+#include <random>
 
 struct GLFWwindow;
 
@@ -77,25 +82,33 @@ private:
     //OpenGL stuff
     GLFWwindow* window;
 
-    GLuint vao;
-    GLuint vbo;
+    CubeBatch cubeBatch;
+    //What the cubit buffer currently holds, so it's only rebuilt when that changes
+    RubiksCube uploadedCube{};
+    int uploadedTurningSide = -2;
+    bool spinUploaded = false;
 
-    GLuint shaderProgram;
-    GLint sidesUniform;
-    GLint transformUniform;
-    GLint colorSchemeUniforms[7];
+    CubeDashboard dashboard;
+    bool showDashboard = false;
+    bool dashboardRandomMoves = true;
+    int dashboardSize = 100;
+    std::mt19937 dashboardRandom{std::random_device{}()};
 
     std::optional<CubeScanner> scanner;
     CuberConnection robot;
+    //Every robot is sent the same moves and reports them back, so only one of them turns the cube on screen. -1 until
+    //one has reported a move
+    int followedRobot = -1;
+    std::vector<RobotInfo> connectedRobots;
+    RobotCostModel robotCostModel;
 
     char robotIpField[20];
 
-    std::optional<std::thread> solverThread;
+    //Declared after robotCostModel, so it's stopped before the cost model its jobs use goes away
+    SolverService solverService{1};
+    std::optional<SolveTicket> solverJob;
     std::optional<std::vector<Move>> solverResult;
-    std::string solverStatusMessage;
-    std::mutex solverMutex;
     SolverState solverState = SolverState::OFF;
-    bool haltSolver = false;
     std::chrono::duration<double> timeTaken;
 
     //Cube handling
@@ -107,20 +120,13 @@ private:
     void initGL();
     void shutdownGL();
 
-    void checkShaderCompileErrors(GLuint shader, const char *string);
-
     //Other
-    void renderCorner(Corner corner, glm::mat4 viewModel, Side currSpin, glm::mat4 spinTransform);
-    void renderEdge(Edge edge, glm::mat4 viewModel, Side currSpin, glm::mat4 spinTransform);
-    void renderCenter(Side side, glm::mat4 viewModel, Side currSpin, glm::mat4 spinTransform) const;
-
     void processMoves(double t);
 
-    void renderCubit(glm::mat4 model, glm::mat4 viewProj, int *sides) const;
-
     void processInput(double dt, double currTime);
 
     void render(double dt, double currTime);
+    void renderDashboard(double currTime);
 
     void renderImGui();
 
@@ -131,6 +137,8 @@ private:
 
     void launchSolver();
     void stopSolver();
+    //Picks up the result of the solver job once it's done, never waits for it
+    void pollSolver();
 };
 
 #endif //RUBIK_CUBERENDERER_H
@@ -3,13 +3,18 @@
 //
 
 #include "CubeScanner.h"
+#include "cube/PermutationRanking.h"
+#include "util/Assignment.h"
 #include <iostream>
+#include <chrono>
+#include <climits>
+#include <algorithm>
 
 std::string SIDE_NAMES[6] = {"front", "back", "left", "right", "top", "bottom"};
 Side SIDE_ORDER[6] = {Side::TOP, Side::FRONT, Side::RIGHT, Side::BACK, Side::LEFT, Side::BOTTOM};
 
-CubeScanner::CubeScanner()
-    :camera()
+CubeScanner::CubeScanner(bool showDebugWindows, bool autoAdvance)
+    :camera(), showDebugWindows(showDebugWindows), autoAdvance(autoAdvance)
 {
     int deviceID = 0;
     int apiID = cv::CAP_ANY;
@@ -18,137 +23,253 @@ CubeScanner::CubeScanner()
 
     if (!camera.isOpened()) {
         std::cerr << "ERROR! Unable to open camera\n";
+        return;
     }
+
+    captureThread = std::thread(&CubeScanner::captureLoop, this);
+    detectionThread = std::thread(&CubeScanner::detectionLoop, this);
 }
 
 CubeScanner::~CubeScanner() {
+    running = false;
+    frameRing.close();
+
+    if (captureThread.joinable()) captureThread.join();
+    if (detectionThread.joinable()) detectionThread.join();
+
     camera.release();
     cv::destroyAllWindows();
 }
 
-cv::Point getContourCenter(std::vector<cv::Point>& contour) {
-    cv::Moments moments = cv::moments(contour);
+FrameRing::FrameRing(int capacity) : frames(capacity) {
+
+}
+
+void FrameRing::push(cv::Mat frame) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (count == (int) frames.size()) {
+            head = (head + 1) % frames.size();
+            count--;
+            dropped++;
+        }
 
-    if (moments.m00 == 0) {
-        return {-1, -1};
+        frames[(head + count) % frames.size()] = std::move(frame);
+        count++;
     }
 
-    return cv::Point(moments.m10 / moments.m00, moments.m01 / moments.m00);
+    frameAvailable.notify_one();
 }
 
-Color getAverageColor(std::vector<cv::Point>& contour, cv::Mat& frame) {
-    cv::Mat mask = cv::Mat::zeros(frame.size(), CV_8UC1);
-    cv::drawContours(mask, std::vector<std::vector<cv::Point>>{contour}, -1, cv::Scalar(1), -1);
+std::optional<cv::Mat> FrameRing::popLatest() {
+    std::unique_lock<std::mutex> lock(mutex);
+    frameAvailable.wait(lock, [this]() { return closed || count > 0; });
 
-    cv::Scalar averageColor = cv::mean(frame, mask);
+    if (closed) {
+        return std::nullopt;
+    }
 
-    return {(int) averageColor[2], (int) averageColor[1], (int) averageColor[0]};
+    cv::Mat frame = std::move(frames[(head + count - 1) % frames.size()]);
+
+    //Everything older is stale now
+    dropped += count - 1;
+    for (int i = 0; i < count; i++) {
+        frames[(head + i) % frames.size()].release();
+    }
+    head = 0;
+    count = 0;
+
+    return frame;
+}
+
+void FrameRing::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+    }
+
+    frameAvailable.notify_all();
+}
+
+uint64_t FrameRing::getDropped() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return dropped;
+}
+
+void CubeScanner::captureLoop() {
+    while (running) {
+        cv::Mat frame;
+
+        if (!camera.read(frame) || frame.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        frameRing.push(std::move(frame));
+    }
+}
+
+void CubeScanner::detectionLoop() {
+    while (true) {
+        std::optional<cv::Mat> frame = frameRing.popLatest();
+        if (!frame) return;
+
+        auto start = std::chrono::high_resolution_clock::now();
+
+        ScanResult result;
+        result.frame = std::move(*frame);
+
+        result.area = getScanArea(result.frame);
+        cv::Mat cropped = result.frame(result.area);
+        result.face = tryScanFace(cropped, scanContext, showDebugWindows ? &result.debug : nullptr);
+
+        auto end = std::chrono::high_resolution_clock::now();
+        result.detectionMillis = std::chrono::duration<double, std::milli>(end - start).count();
+
+        std::lock_guard<std::mutex> lock(resultMutex);
+        latestResult = std::move(result);
+    }
+}
+
+cv::Rect getScanArea(const cv::Mat& frame) {
+    int width = frame.cols;
+    int height = frame.rows;
+
+    int areaSize = std::min(width, height) / 2;
+    int areaX = (width - areaSize) / 2;
+    int areaY = (height - areaSize) / 2;
+
+    return cv::Rect(areaX, areaY, areaSize, areaSize);
 }
 
-std::optional<Face> tryScanFace(cv::Mat& frame) {
-    cv::Mat grayFrame;
-    cv::cvtColor(frame, grayFrame, cv::COLOR_BGR2GRAY);
+FaceScanContext::FaceScanContext()
+    :kernel(cv::getStructuringElement(cv::MORPH_RECT, cv::Size(9, 9)))
+{
+
+}
+
+Color getAverageColor(FaceScanContext& context, int contour, cv::Mat& frame) {
+    //Only the sticker's bounding box is masked and averaged, not the whole frame
+    cv::Rect box = cv::boundingRect(context.contours[contour]) & cv::Rect(0, 0, frame.cols, frame.rows);
+
+    //Allocates on the first frame only, the mask keeps its size after that
+    context.mask.create(frame.size(), CV_8UC1);
+    cv::Mat mask = context.mask(box);
+    mask.setTo(cv::Scalar(0));
+    cv::drawContours(mask, context.contours, contour, cv::Scalar(1), cv::FILLED, cv::LINE_8, cv::noArray(), INT_MAX, cv::Point(-box.x, -box.y));
+
+    cv::Scalar averageColor = cv::mean(frame(box), mask);
 
-    cv::Mat blurredFrame;
-    cv::GaussianBlur(grayFrame, blurredFrame, cv::Size(3, 3), 0);
+    return {(int) averageColor[2], (int) averageColor[1], (int) averageColor[0]};
+}
 
-    cv::Mat cannyFrame;
-    cv::Canny(blurredFrame, cannyFrame, 30, 60, 3);
+std::optional<Face> tryScanFace(cv::Mat& frame, FaceScanContext& context, ScanDebugImages* debug) {
+    cv::cvtColor(frame, context.grayFrame, cv::COLOR_BGR2GRAY);
+    cv::GaussianBlur(context.grayFrame, context.blurredFrame, cv::Size(3, 3), 0);
+    cv::Canny(context.blurredFrame, context.cannyFrame, 30, 60, 3);
+    cv::dilate(context.cannyFrame, context.dilatedFrame, context.kernel);
 
-    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(9, 9));
-    cv::Mat dilatedFrame;
-    cv::dilate(cannyFrame, dilatedFrame, kernel);
+    cv::findContours(context.dilatedFrame, context.contours, context.hierarchy, cv::RETR_TREE, cv::CHAIN_APPROX_SIMPLE);
+
+    //Debug images are fresh every frame, the caller hands them to another thread
+    cv::Mat* drawing = nullptr;
+    if (debug) {
+        debug->canny = context.cannyFrame.clone();
+        debug->drawing = cv::Mat::zeros(context.dilatedFrame.size(), CV_8UC3);
+        drawing = &debug->drawing;
+    }
 
-    std::vector<std::vector<cv::Point>> contours;
-    std::vector<cv::Vec4i> hierarchy;
-    cv::findContours(dilatedFrame, contours, hierarchy, cv::RETR_TREE, cv::CHAIN_APPROX_SIMPLE);
+    std::vector<int>& stickers = context.stickers;
+    std::vector<cv::Point>& centers = context.centers;
+    stickers.clear();
+    centers.clear();
 
-    std::vector<std::vector<cv::Point>> goodContours;
+    for (int i = 0; i < context.contours.size(); i++) {
+        auto& contour = context.contours[i];
 
-    for (int i = 0; i < contours.size(); i++) {
-        auto& contour = contours[i];
-        double area = cv::contourArea(contour);
+        //Moments give the area as well, and they're needed for the center anyway
+        cv::Moments moments = cv::moments(contour);
+        double area = std::abs(moments.m00);
 
         if (area < 300 || area > 3000) continue;
 
-        std::vector<cv::Point> convexHull;
-        cv::convexHull(contour, convexHull);
-        double convexHullArea = cv::contourArea(convexHull);
+        cv::convexHull(contour, context.convexHull);
+        double convexHullArea = cv::contourArea(context.convexHull);
         double solidity = area / convexHullArea;
 
         if (solidity < 0.9) continue;
 
         double perimeter = cv::arcLength(contour, true);
         double epsilon = 0.1 * perimeter;
-        std::vector<cv::Point> approx;
-        cv::approxPolyDP(contour, approx, epsilon, true);
+        cv::approxPolyDP(contour, context.approx, epsilon, true);
 
-        if (approx.size() != 4) continue;
+        if (context.approx.size() != 4) continue;
 
         //Check that it is square-like
-        std::vector<double> distances;
-        for (int i = 0; i < 4; i++) {
-            cv::Point p1 = approx[i];
-            cv::Point p2 = approx[(i + 1) % 4];
-            distances.push_back(cv::norm(p1 - p2));
+        double distances[4];
+        for (int k = 0; k < 4; k++) {
+            cv::Point p1 = context.approx[k];
+            cv::Point p2 = context.approx[(k + 1) % 4];
+            distances[k] = cv::norm(p1 - p2);
         }
 
-        std::sort(distances.begin(), distances.end());
+        std::sort(distances, distances + 4);
 
         double minDistance = distances[0];
         double maxDistance = distances[3];
 
         if (maxDistance / minDistance > 1.4) continue;
 
-        goodContours.push_back(contour);
-    }
-
-    cv::Mat drawing = cv::Mat::zeros(dilatedFrame.size(), CV_8UC3);
-    for (int i = 0; i < goodContours.size(); i++) {
-        cv::Scalar color = cv::Scalar(0, 255, 0);
-        cv::drawContours(drawing, goodContours, i, color, 2, cv::LINE_8, hierarchy, 0);
+        stickers.push_back(i);
+        centers.push_back(cv::Point(moments.m10 / moments.m00, moments.m01 / moments.m00));
     }
 
-    cv::imshow("canny", cannyFrame);
+    int numStickers = stickers.size();
 
+    if (drawing) {
+        for (int i = 0; i < numStickers; i++) {
+            cv::drawContours(*drawing, context.contours, stickers[i], cv::Scalar(0, 255, 0), 2, cv::LINE_8, context.hierarchy, 0);
+        }
+    }
 
-    if (goodContours.size() < 9) {
-        cv::imshow("drawing", drawing);
+    if (numStickers < 9) {
         return std::nullopt;
     }
 
-
-    std::vector<std::vector<int>> neighbors(goodContours.size());
     double maxDistance = (frame.cols / 3.0) * sqrt(2) * 1.1;
     double minDistance = maxDistance * 0.5 / sqrt(2);
 
-    for (int i = 0; i < goodContours.size(); i++) {
-        auto& contour1 = goodContours[i];
-        cv::Point center1 = getContourCenter(contour1);
-
-        for (int j = 0; j < goodContours.size(); j++) {
-            if (i == j) continue;
-
-            auto& contour2 = goodContours[j];
-            cv::Point center2 = getContourCenter(contour2);
+    auto areNeighbors = [&](int a, int b) {
+        double distance = cv::norm(centers[a] - centers[b]);
+        return distance < maxDistance && distance > minDistance;
+    };
 
-            double distance = cv::norm(center1 - center2);
+    //Each pair is only measured once
+    std::vector<int>& neighborCounts = context.neighborCounts;
+    neighborCounts.assign(numStickers, 0);
 
-            if (distance < maxDistance && distance > minDistance) {
-                neighbors[i].push_back(j);
+    for (int i = 0; i < numStickers; i++) {
+        for (int j = i + 1; j < numStickers; j++) {
+            if (areNeighbors(i, j)) {
+                neighborCounts[i]++;
+                neighborCounts[j]++;
             }
         }
+    }
 
+    if (drawing) {
         //Draw number of neighbors
-        cv::putText(drawing, std::to_string(neighbors[i].size()), center1, cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(0, 0, 255), 2);
+        for (int i = 0; i < numStickers; i++) {
+            cv::putText(*drawing, std::to_string(neighborCounts[i]), centers[i], cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(0, 0, 255), 2);
+        }
     }
 
     //Find the center, which has 8 neighbors
     int centerIndex = -1;
-    for (int i = 0; i < goodContours.size(); i++) {
-        if (neighbors[i].size() == 8) {
+    for (int i = 0; i < numStickers; i++) {
+        if (neighborCounts[i] == 8) {
             if (centerIndex != -1) {
-                cv::imshow("drawing", drawing);
                 return std::nullopt;
             }
 
@@ -157,53 +278,56 @@ std::optional<Face> tryScanFace(cv::Mat& frame) {
     }
 
     if (centerIndex == -1) {
-        cv::imshow("drawing", drawing);
         return std::nullopt;
     }
 
-    cv::Point faceCenter = getContourCenter(goodContours[centerIndex]);
+    cv::Point faceCenter = centers[centerIndex];
 
     //Draw center
-    cv::drawContours(drawing, goodContours, centerIndex, cv::Scalar(255, 0, 0), 2, cv::LINE_8, hierarchy, 0);
-
-    //The edges will be the four closest neighbors
-    std::vector<int> edgeIndices;
-    std::vector<cv::Point> edgeCenters;
-    std::vector<cv::Point> edgeDirections;
-
-    std::sort(neighbors[centerIndex].begin(), neighbors[centerIndex].end(), [&](int a, int b) {
-        cv::Point aCenter = getContourCenter(goodContours[a]);
-        cv::Point bCenter = getContourCenter(goodContours[b]);
+    if (drawing) {
+        cv::drawContours(*drawing, context.contours, stickers[centerIndex], cv::Scalar(255, 0, 0), 2, cv::LINE_8, context.hierarchy, 0);
+    }
 
-        double aDistance = cv::norm(faceCenter - aCenter);
-        double bDistance = cv::norm(faceCenter - bCenter);
+    std::vector<int>& centerNeighbors = context.centerNeighbors;
+    centerNeighbors.clear();
+    for (int i = 0; i < numStickers; i++) {
+        if (i != centerIndex && areNeighbors(centerIndex, i)) {
+            centerNeighbors.push_back(i);
+        }
+    }
 
-        return aDistance < bDistance;
+    //The edges will be the four closest neighbors
+    std::sort(centerNeighbors.begin(), centerNeighbors.end(), [&](int a, int b) {
+        return cv::norm(faceCenter - centers[a]) < cv::norm(faceCenter - centers[b]);
     });
 
+    int edgeIndices[4];
+    cv::Point edgeCenters[4];
+    cv::Point edgeDirections[4];
+
     for (int i = 0; i < 4; i++) {
-        edgeIndices.push_back(neighbors[centerIndex][i]);
+        edgeIndices[i] = centerNeighbors[i];
 
-        cv::Point center = getContourCenter(goodContours[centerIndex]);
-        cv::Point edgeCenter = getContourCenter(goodContours[edgeIndices[i]]);
+        cv::Point edgeCenter = centers[edgeIndices[i]];
 
-        cv::Point direction = edgeCenter - center;
+        cv::Point direction = edgeCenter - faceCenter;
         double length = cv::norm(direction);
 
         //If the edge direction is too far off the cardinal directions, return nothing
         if (abs(direction.x) > length * 0.2 && abs(direction.y) > length * 0.2) {
-            cv::imshow("drawing", drawing);
             return std::nullopt;
         }
 
-        edgeDirections.push_back(direction);
-        edgeCenters.push_back(edgeCenter);
+        edgeDirections[i] = direction;
+        edgeCenters[i] = edgeCenter;
 
-        cv::drawContours(drawing, goodContours, edgeIndices[i], cv::Scalar(255, 0, 0), 2, cv::LINE_8, hierarchy, 0);
+        if (drawing) {
+            cv::drawContours(*drawing, context.contours, stickers[edgeIndices[i]], cv::Scalar(255, 0, 0), 2, cv::LINE_8, context.hierarchy, 0);
+        }
     }
 
-    std::vector<int> cornerIndices;
-    std::vector<cv::Point> cornerCenters;
+    int cornerIndices[4];
+    cv::Point cornerCenters[4];
 
     //Find the corners
     for (int i = 0; i < 4; i++) {
@@ -216,12 +340,10 @@ std::optional<Face> tryScanFace(cv::Mat& frame) {
         double minDistance = std::numeric_limits<double>::max();
         int minIndex = -1;
 
-        for (int j = 0; j < goodContours.size(); j++) {
+        for (int j = 0; j < numStickers; j++) {
             if (j == centerIndex || j == edgeIndex) continue;
 
-            cv::Point center = getContourCenter(goodContours[j]);
-
-            double distance = cv::norm(expectedCornerPos - center);
+            double distance = cv::norm(expectedCornerPos - centers[j]);
 
             if (distance < minDistance) {
                 minDistance = distance;
@@ -232,66 +354,61 @@ std::optional<Face> tryScanFace(cv::Mat& frame) {
         double distanceDeviation = abs(minDistance) / expectedDistance;
 
         if (distanceDeviation > 0.2) {
-            cv::imshow("drawing", drawing);
             return std::nullopt;
         }
 
-        cornerIndices.push_back(minIndex);
-        cornerCenters.push_back(getContourCenter(goodContours[minIndex]));
+        cornerIndices[i] = minIndex;
+        cornerCenters[i] = centers[minIndex];
     }
 
-    for (int i = 0; i < 4; i++) {
-        cv::drawContours(drawing, goodContours, cornerIndices[i], cv::Scalar(255, 0, 0), 2, cv::LINE_8, hierarchy, 0);
+    if (drawing) {
+        for (int i = 0; i < 4; i++) {
+            cv::drawContours(*drawing, context.contours, stickers[cornerIndices[i]], cv::Scalar(255, 0, 0), 2, cv::LINE_8, context.hierarchy, 0);
+        }
     }
 
     Face face;
 
-    Color centerColor = getAverageColor(goodContours[centerIndex], frame);
+    Color centerColor = getAverageColor(context, stickers[centerIndex], frame);
     face.colors[1][1] = centerColor;
     //Fill contour with color
-    cv::drawContours(drawing, goodContours, centerIndex, cv::Scalar(centerColor.b, centerColor.g, centerColor.r), cv::FILLED, cv::LINE_8, hierarchy, 0);
+    if (drawing) {
+        cv::drawContours(*drawing, context.contours, stickers[centerIndex], cv::Scalar(centerColor.b, centerColor.g, centerColor.r), cv::FILLED, cv::LINE_8, context.hierarchy, 0);
+    }
 
-    std::vector<int> edgeOrder = {0, 1, 2, 3};
-    std::vector<int> cornerOrder = {0, 1, 2, 3};
+    int edgeOrder[4] = {0, 1, 2, 3};
+    int cornerOrder[4] = {0, 1, 2, 3};
 
-    std::sort(edgeOrder.begin(), edgeOrder.end(), [&](int a, int b) {
+    std::sort(edgeOrder, edgeOrder + 4, [&](int a, int b) {
         return edgeCenters[a].y < edgeCenters[b].y;
     });
-    std::sort(edgeOrder.begin() + 1, edgeOrder.begin() + 3, [&](int a, int b) {
+    std::sort(edgeOrder + 1, edgeOrder + 3, [&](int a, int b) {
         return edgeCenters[a].x < edgeCenters[b].x;
     });
 
-    face.colors[0][1] = getAverageColor(goodContours[edgeIndices[edgeOrder[0]]], frame);
-    face.colors[1][0] = getAverageColor(goodContours[edgeIndices[edgeOrder[1]]], frame);
-    face.colors[1][2] = getAverageColor(goodContours[edgeIndices[edgeOrder[2]]], frame);
-    face.colors[2][1] = getAverageColor(goodContours[edgeIndices[edgeOrder[3]]], frame);
+    face.colors[0][1] = getAverageColor(context, stickers[edgeIndices[edgeOrder[0]]], frame);
+    face.colors[1][0] = getAverageColor(context, stickers[edgeIndices[edgeOrder[1]]], frame);
+    face.colors[1][2] = getAverageColor(context, stickers[edgeIndices[edgeOrder[2]]], frame);
+    face.colors[2][1] = getAverageColor(context, stickers[edgeIndices[edgeOrder[3]]], frame);
 
-    std::sort(cornerOrder.begin(), cornerOrder.end(), [&](int a, int b) {
+    std::sort(cornerOrder, cornerOrder + 4, [&](int a, int b) {
         return cornerCenters[a].y < cornerCenters[b].y;
     });
-    std::sort(cornerOrder.begin(), cornerOrder.begin() + 2, [&](int a, int b) {
+    std::sort(cornerOrder, cornerOrder + 2, [&](int a, int b) {
         return cornerCenters[a].x < cornerCenters[b].x;
     });
-    std::sort(cornerOrder.begin() + 2, cornerOrder.begin() + 4, [&](int a, int b) {
+    std::sort(cornerOrder + 2, cornerOrder + 4, [&](int a, int b) {
         return cornerCenters[a].x < cornerCenters[b].x;
     });
 
-    face.colors[0][0] = getAverageColor(goodContours[cornerIndices[cornerOrder[0]]], frame);
-    face.colors[0][2] = getAverageColor(goodContours[cornerIndices[cornerOrder[1]]], frame);
-    face.colors[2][0] = getAverageColor(goodContours[cornerIndices[cornerOrder[2]]], frame);
-    face.colors[2][2] = getAverageColor(goodContours[cornerIndices[cornerOrder[3]]], frame);
-
-    cv::imshow("drawing", drawing);
+    face.colors[0][0] = getAverageColor(context, stickers[cornerIndices[cornerOrder[0]]], frame);
+    face.colors[0][2] = getAverageColor(context, stickers[cornerIndices[cornerOrder[1]]], frame);
+    face.colors[2][0] = getAverageColor(context, stickers[cornerIndices[cornerOrder[2]]], frame);
+    face.colors[2][2] = getAverageColor(context, stickers[cornerIndices[cornerOrder[3]]], frame);
 
     return face;
 }
 
-struct HSVColor {
-    int h;
-    int s;
-    int v;
-};
-
 HSVColor rgbToHsv(Color rgb) {
     HSVColor hsv;
 
@@ -328,7 +445,9 @@ HSVColor rgbToHsv(Color rgb) {
 }
 
 double getDistance(HSVColor hsvA, HSVColor hsvB) {
-    double h = hsvA.h - hsvB.h;
+    //Hue wraps around, red can be on either side of 0
+    double h = std::abs(hsvA.h - hsvB.h);
+    h = std::min(h, 360 - h);
     double s = hsvA.s - hsvB.s;
     double v = hsvA.v - hsvB.v;
 
@@ -339,145 +458,401 @@ double getDistance(HSVColor hsvA, HSVColor hsvB) {
     return sqrt(h * h * 5 + s * s + v * v);
 }
 
-RubiksCube constructCube(Face faces[6]) {
+//How far each scanned sticker is from the center color of every side
+typedef double StickerCosts[6][3][3][6];
+
+//Stickers nothing has been put on yet, so a single piece can be placed and its stickers found again
+static RubiksCube emptyCube() {
     RubiksCube cube;
+    memset(cube.sides, 6, sizeof(cube.sides));
+    return cube;
+}
 
-    HSVColor centers[6];
+static RubiksCube placePiece(bool corner, int position, int piece, int orientation) {
+    RubiksCube cube = emptyCube();
 
-    for (int i = 0; i < 6; i++) {
-        centers[i] = rgbToHsv(faces[i].colors[1][1]);
+    if (corner) {
+        cube.setCorner((Corner) position, (Corner) piece, orientation);
+    } else {
+        cube.setEdge((Edge) position, (Edge) piece, orientation);
     }
 
-    struct StickerData {
-        int face, i, j;
-        double distances[6];
-
-        StickerData(int face, int i, int j, Color stickerColor, HSVColor* centers) {
-            this->face = face;
-            this->i = i;
-            this->j = j;
+    return cube;
+}
 
-            HSVColor hsv = rgbToHsv(stickerColor);
+static double getPlacementCost(const RubiksCube& placement, const StickerCosts& costs) {
+    double cost = 0;
 
-            for (int k = 0; k < 6; k++) {
-                distances[k] = getDistance(hsv, centers[k]);
+    for (int face = 0; face < 6; face++) {
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                if (placement.sides[face][i][j] < 6) {
+                    cost += costs[face][i][j][placement.sides[face][i][j]];
+                }
             }
         }
-    };
+    }
 
-    std::vector<StickerData> edges;
-    std::vector<StickerData> corners;
+    return cost;
+}
 
-    for (int i = 0; i < 6; i++) {
-        for (int j = 0; j < 3; j++) {
-            for (int k = 0; k < 3; k++) {
-                if (j == 1 && k == 1) {
-                    continue;
-                }
+//The best coloring with four stickers of every color on the edges and four on the corners, one matching per piece type.
+//It doesn't know about pieces, so it can still describe a cube that doesn't exist
+static RubiksCube assignStickers(const StickerCosts& costs) {
+    RubiksCube cube;
+
+    for (int pieceType = 0; pieceType < 2; pieceType++) {
+        bool edges = pieceType == 0;
 
-                if (j == 1 || k == 1) {
-                    edges.push_back(StickerData(i, j, k, faces[i].colors[j][k], centers));
-                } else {
-                    corners.push_back(StickerData(i, j, k, faces[i].colors[j][k], centers));
+        struct StickerPos {
+            int face, i, j;
+        };
+        std::vector<StickerPos> stickers;
+
+        for (int face = 0; face < 6; face++) {
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 3; j++) {
+                    if (i == 1 && j == 1) continue;
+                    if ((i == 1 || j == 1) == edges) {
+                        stickers.push_back({face, i, j});
+                    }
                 }
             }
         }
-    }
 
-    int numEdges[6] = {0};
-    int numCorners[6] = {0};
+        //Column 4 * k + n is the n-th sticker that gets color k
+        int n = stickers.size();
+        std::vector<double> cost(n * n);
+        for (int row = 0; row < n; row++) {
+            for (int col = 0; col < n; col++) {
+                cost[row * n + col] = costs[stickers[row].face][stickers[row].i][stickers[row].j][col / 4];
+            }
+        }
+
+        std::vector<int> assignment = solveAssignment(cost, n);
+        for (int row = 0; row < n; row++) {
+            cube.sides[stickers[row].face][stickers[row].i][stickers[row].j] = (Side) (assignment[row] / 4);
+        }
+    }
 
-    while (edges.size()) {
-        int bestEdgeIndex = -1;
-        int bestFaceIndex = -1;
+    return cube;
+}
 
-        double bestDistance = 1000000;
+//Where every piece of one type goes and how it's turned (the orientation setCorner and setEdge take)
+struct PiecePlacement {
+    std::vector<int> pieces;
+    std::vector<int> orientations;
+    double cost = std::numeric_limits<double>::infinity();
+};
 
-        for (int i = 0; i < edges.size(); i++) {
-            for (int j = 0; j < 6; j++) {
-                if (numEdges[j] < 4 && edges[i].distances[j] < bestDistance) {
-                    bestDistance = edges[i].distances[j];
-                    bestEdgeIndex = i;
-                    bestFaceIndex = j;
-                }
+//Gives up on proving the cheapest placement after this many permutations, the best one found so far is still used
+const int MAX_PIECE_PERMUTATIONS = 5000;
+
+/*
+ * The cheapest placement of the corners (or edges) for an even (best[0]) and an odd (best[1]) permutation, with a twist
+ * (or flip) total the cube allows. Permutations come from enumerateAssignments, ranked by what they'd cost if every
+ * piece could take its best orientation. That's a lower bound on the real cost, so once it passes the best placement of
+ * both parities nothing better is left.
+ */
+static void searchPieces(bool corners, const StickerCosts& costs, PiecePlacement best[2]) {
+    int n = corners ? 8 : 12;
+    int numOrientations = corners ? 3 : 2;
+
+    //[position][piece][orientation]
+    std::vector<double> placementCost(n * n * numOrientations);
+    std::vector<int> twist(n * n * numOrientations);
+    std::vector<double> relaxedCost(n * n, std::numeric_limits<double>::infinity());
+
+    for (int pos = 0; pos < n; pos++) {
+        for (int piece = 0; piece < n; piece++) {
+            for (int o = 0; o < numOrientations; o++) {
+                RubiksCube placement = placePiece(corners, pos, piece, o);
+                int index = (pos * n + piece) * numOrientations + o;
+
+                placementCost[index] = getPlacementCost(placement, costs);
+                twist[index] = corners ? placement.getCornerOrientation((Corner) pos) : placement.getEdgeOrientation((Edge) pos);
+                relaxedCost[pos * n + piece] = std::min(relaxedCost[pos * n + piece], placementCost[index]);
             }
         }
+    }
 
-        numEdges[bestFaceIndex]++;
-        StickerData& edge = edges[bestEdgeIndex];
-        cube.sides[edge.face][edge.i][edge.j] = (Side) bestFaceIndex;
+    //dp[pos][r] is the cheapest way to orient the first pos pieces with a twist total of r
+    std::vector<double> dp((n + 1) * numOrientations);
+    std::vector<int> choice(n * numOrientations);
 
-        edges.erase(edges.begin() + bestEdgeIndex);
-    }
+    enumerateAssignments(relaxedCost, n, MAX_PIECE_PERMUTATIONS, [&](const std::vector<int>& pieces, double lowerBound) {
+        if (lowerBound >= std::max(best[0].cost, best[1].cost)) {
+            return false;
+        }
+
+        std::fill(dp.begin(), dp.end(), std::numeric_limits<double>::infinity());
+        dp[0] = 0;
 
-    while (corners.size()) {
-        int bestCornerIndex = -1;
-        int bestFaceIndex = -1;
+        for (int pos = 0; pos < n; pos++) {
+            for (int r = 0; r < numOrientations; r++) {
+                if (dp[pos * numOrientations + r] == std::numeric_limits<double>::infinity()) continue;
 
-        double bestDistance = 1000000;
+                for (int o = 0; o < numOrientations; o++) {
+                    int index = (pos * n + pieces[pos]) * numOrientations + o;
+                    int next = (r + twist[index]) % numOrientations;
+                    double cost = dp[pos * numOrientations + r] + placementCost[index];
 
-        for (int i = 0; i < corners.size(); i++) {
-            for (int j = 0; j < 6; j++) {
-                if (numCorners[j] < 4 && corners[i].distances[j] < bestDistance) {
-                    bestDistance = corners[i].distances[j];
-                    bestCornerIndex = i;
-                    bestFaceIndex = j;
+                    if (cost < dp[(pos + 1) * numOrientations + next]) {
+                        dp[(pos + 1) * numOrientations + next] = cost;
+                        choice[pos * numOrientations + next] = o;
+                    }
                 }
             }
         }
 
-        numCorners[bestFaceIndex]++;
-        StickerData& corner = corners[bestCornerIndex];
-        cube.sides[corner.face][corner.i][corner.j] = (Side) bestFaceIndex;
+        PiecePlacement& target = best[permutationParity(pieces.data(), n)];
+        if (dp[n * numOrientations] >= target.cost) {
+            return true;
+        }
+
+        target.pieces = pieces;
+        target.cost = dp[n * numOrientations];
+        target.orientations.assign(n, 0);
+
+        //Walk back from a total twist of 0
+        int r = 0;
+        for (int pos = n - 1; pos >= 0; pos--) {
+            int o = choice[pos * numOrientations + r];
+            target.orientations[pos] = o;
+
+            int index = (pos * n + pieces[pos]) * numOrientations + o;
+            r = (r - twist[index] % numOrientations + numOrientations) % numOrientations;
+        }
+
+        return true;
+    });
+}
+
+//The cheapest cube that can actually be solved: real pieces, each used once, with valid twists, flips and parity
+static RubiksCube findSolvableCube(const StickerCosts& costs) {
+    PiecePlacement corners[2];
+    PiecePlacement edges[2];
+
+    searchPieces(true, costs, corners);
+    searchPieces(false, costs, edges);
+
+    //Corners and edges need the same permutation parity. The search can give up before it finds a placement of some
+    //parity, that one then costs infinity and has no pieces
+    double parityCost[2] = {corners[0].cost + edges[0].cost, corners[1].cost + edges[1].cost};
+    int parity = parityCost[0] <= parityCost[1] ? 0 : 1;
+
+    if (parityCost[parity] == std::numeric_limits<double>::infinity()) {
+        std::cout << "No solvable cube found close to the scanned colors, keeping them as they are" << std::endl;
+        return assignStickers(costs);
+    }
 
-        corners.erase(corners.begin() + bestCornerIndex);
+    RubiksCube cube;
+    for (int pos = 0; pos < 8; pos++) {
+        cube.setCorner((Corner) pos, (Corner) corners[parity].pieces[pos], corners[parity].orientations[pos]);
+    }
+    for (int pos = 0; pos < 12; pos++) {
+        cube.setEdge((Edge) pos, (Edge) edges[parity].pieces[pos], edges[parity].orientations[pos]);
     }
 
     return cube;
 }
 
-std::optional<RubiksCube> CubeScanner::tick() {
-    cv::Mat frame;
-    camera.read(frame);
+RubiksCube constructCube(Face faces[6]) {
+    HSVColor centers[6];
 
-    int width = frame.cols;
-    int height = frame.rows;
+    for (int i = 0; i < 6; i++) {
+        centers[i] = rgbToHsv(faces[i].colors[1][1]);
+    }
 
-    int areaSize = std::min(width, height) / 2;
-    int areaX = (width - areaSize) / 2;
-    int areaY = (height - areaSize) / 2;
+    StickerCosts costs;
 
-    cv::Rect area(areaX, areaY, areaSize, areaSize);
-    cv::Mat cropped = frame(area);
-    //Draw rectangle
-    if (this->currFace) {
-        cv::rectangle(frame, area, cv::Scalar(0, 255, 0), 4);
-    } else {
-        cv::rectangle(frame, area, cv::Scalar(0, 0, 255), 4);
+    for (int face = 0; face < 6; face++) {
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                HSVColor hsv = rgbToHsv(faces[face].colors[i][j]);
+
+                for (int k = 0; k < 6; k++) {
+                    costs[face][i][j][k] = getDistance(hsv, centers[k]);
+                }
+            }
+        }
     }
 
-    auto face = tryScanFace(cropped);
-    if (face) {
-        this->currFace = face.value();
+    //Usually the plain matching is already a real cube
+    RubiksCube cube = assignStickers(costs);
+    if (cube.isSolvable()) {
+        return cube;
     }
 
-    //Draw small cube in top left
-    if (this->currFace) {
+    std::cout << "Scanned colors don't form a solvable cube, looking for the closest one that does" << std::endl;
+    return findSolvableCube(costs);
+}
+
+bool FaceAccumulator::add(const Face& face) {
+    bool fits = true;
+
+    if (count > 0) {
+        int disagreeing = 0;
+
         for (int r = 0; r < 3; r++) {
             for (int c = 0; c < 3; c++) {
-                cv::Rect rect(20 + 30 * c, 20 + 30 * r, 30, 30);
-                Color color = this->currFace->colors[r][c];
-                cv::rectangle(frame, rect, cv::Scalar(color.b, color.g, color.r), cv::FILLED);
+                if (getDistance(rgbToHsv(face.colors[r][c]), rgbToHsv(estimate.colors[r][c])) > AGREE_DISTANCE) {
+                    disagreeing++;
+                }
             }
         }
+
+        if (disagreeing >= MISMATCH_STICKERS) {
+            fits = false;
+
+            //Most likely a blurred frame, unless it keeps happening
+            if (++mismatches < RESTART_FRAMES) return false;
+            reset();
+        }
     }
 
-    std::string text = "Please place " + SIDE_NAMES[SIDE_ORDER[this->currFaceIdx]] + " face in the cube area";
-    cv::putText(frame, text, cv::Point(130, 65), cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(0, 0, 0), 2);
+    if (fits) mismatches = 0;
+
+    samples[next] = face;
+    next = (next + 1) % WINDOW;
+    count = std::min(count + 1, WINDOW);
 
-    cv::imshow("Camera", frame);
+    update();
+    return fits;
+}
+
+void FaceAccumulator::reset() {
+    next = 0;
+    count = 0;
+    mismatches = 0;
+    confidence = 0;
+}
+
+std::optional<Face> FaceAccumulator::getFace() const {
+    if (count == 0) return std::nullopt;
 
-    int key = cv::waitKey(30);
+    return estimate;
+}
+
+double FaceAccumulator::getConfidence() const {
+    return confidence;
+}
+
+int FaceAccumulator::getNumSamples() const {
+    return count;
+}
+
+void FaceAccumulator::update() {
+    confidence = 1;
+
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) {
+            int channels[3][WINDOW];
+
+            for (int i = 0; i < count; i++) {
+                Color color = samples[i].colors[r][c];
+                channels[0][i] = color.r;
+                channels[1][i] = color.g;
+                channels[2][i] = color.b;
+            }
+
+            //Each channel on its own, a blurred frame pulls one sample off but never moves the median far
+            int median[3];
+            for (int k = 0; k < 3; k++) {
+                std::nth_element(channels[k], channels[k] + count / 2, channels[k] + count);
+                median[k] = channels[k][count / 2];
+            }
+
+            Color fused = {median[0], median[1], median[2]};
+            estimate.colors[r][c] = fused;
+
+            HSVColor fusedHsv = rgbToHsv(fused);
+            int agreeing = 0;
+
+            for (int i = 0; i < count; i++) {
+                if (getDistance(rgbToHsv(samples[i].colors[r][c]), fusedHsv) <= AGREE_DISTANCE) {
+                    agreeing++;
+                }
+            }
+
+            confidence = std::min(confidence, (double) agreeing / WINDOW);
+        }
+    }
+}
+
+std::optional<RubiksCube> CubeScanner::tick() {
+    //All six faces are in, only the cube is left to wait for
+    if (constructedCube.valid()) {
+        cv::waitKey(1);
+
+        if (constructedCube.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            return constructedCube.get();
+        }
+        return std::nullopt;
+    }
+
+    std::optional<ScanResult> result;
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        result.swap(latestResult);
+    }
+
+    //Only redrawn when there's a new frame, the windows keep showing the last one until then
+    if (result) {
+        if (result->face) {
+            this->currFace.add(*result->face);
+        }
+
+        std::optional<Face> face = this->currFace.getFace();
+        bool alreadyScanned = face && isAlreadyScanned(*face);
+
+        cv::Mat& frame = result->frame;
+
+        //Draw rectangle
+        if (face && !alreadyScanned) {
+            cv::rectangle(frame, result->area, cv::Scalar(0, 255, 0), 4);
+        } else {
+            cv::rectangle(frame, result->area, cv::Scalar(0, 0, 255), 4);
+        }
+
+        //Draw small cube in top left
+        if (face) {
+            for (int r = 0; r < 3; r++) {
+                for (int c = 0; c < 3; c++) {
+                    cv::Rect rect(20 + 30 * c, 20 + 30 * r, 30, 30);
+                    Color color = face->colors[r][c];
+                    cv::rectangle(frame, rect, cv::Scalar(color.b, color.g, color.r), cv::FILLED);
+                }
+            }
+
+            //Confidence bar underneath, filling up towards the point where the face is accepted
+            double fill = std::min(1.0, this->currFace.getConfidence() / AUTO_ADVANCE_CONFIDENCE);
+            cv::rectangle(frame, cv::Rect(20, 115, 90, 8), cv::Scalar(0, 0, 0), 1);
+            cv::rectangle(frame, cv::Rect(20, 115, (int) (90 * fill), 8), cv::Scalar(0, 255, 0), cv::FILLED);
+        }
+
+        std::string text = alreadyScanned
+            ? "Please turn the cube to the " + SIDE_NAMES[SIDE_ORDER[this->currFaceIdx]] + " face"
+            : "Please place " + SIDE_NAMES[SIDE_ORDER[this->currFaceIdx]] + " face in the cube area";
+        cv::putText(frame, text, cv::Point(130, 65), cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(0, 0, 0), 2);
+
+        std::string stats = "Detection " + std::to_string((int) result->detectionMillis) + " ms, " + std::to_string(frameRing.getDropped()) + " frames skipped, "
+            + std::to_string((int) (this->currFace.getConfidence() * 100)) + "% confidence over " + std::to_string(this->currFace.getNumSamples()) + " frames";
+        cv::putText(frame, stats, cv::Point(130, 95), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 1);
+
+        cv::imshow("Camera", frame);
+        if (!result->debug.canny.empty()) cv::imshow("canny", result->debug.canny);
+        if (!result->debug.drawing.empty()) cv::imshow("drawing", result->debug.drawing);
+
+        //Still holding the face that was just accepted mustn't accept it again for the next side
+        if (autoAdvance && !alreadyScanned && this->currFace.getConfidence() >= AUTO_ADVANCE_CONFIDENCE) {
+            acceptFace();
+            return std::nullopt;
+        }
+    }
+
+    //Just long enough for the windows to handle their events
+    int key = cv::waitKey(1);
 
     //If it's ESC or Q return an empty cube
     if (key == 27 || key == 113) {
@@ -486,19 +861,34 @@ std::optional<RubiksCube> CubeScanner::tick() {
 
     //If it's enter then move on to the next face
     if (key == 13) {
-       if (!this->currFace) return std::nullopt;
+        if (this->currFace.getFace()) acceptFace();
+    }
+
+    return std::nullopt;
+}
 
-        this->faces[SIDE_ORDER[this->currFaceIdx]] = *this->currFace;
-        this->currFaceIdx++;
+void CubeScanner::acceptFace() {
+    this->faces[SIDE_ORDER[this->currFaceIdx]] = *this->currFace.getFace();
+    this->currFaceIdx++;
+    this->currFace.reset();
 
-        if (this->currFaceIdx == 6) {
+    if (this->currFaceIdx == 6) {
+        constructedCube = std::async(std::launch::async, [this]() {
             return constructCube(this->faces);
-        }
+        });
+    }
+}
 
-        this->currFace = std::nullopt;
+bool CubeScanner::isAlreadyScanned(const Face& face) {
+    HSVColor center = rgbToHsv(face.colors[1][1]);
+
+    for (int i = 0; i < this->currFaceIdx; i++) {
+        if (getDistance(center, rgbToHsv(this->faces[SIDE_ORDER[i]].colors[1][1])) <= FaceAccumulator::AGREE_DISTANCE) {
+            return true;
+        }
     }
 
-    return std::nullopt;
+    return false;
 }
 
 Color CubeScanner::getSideColor(Side side, RubiksCube& cube) {
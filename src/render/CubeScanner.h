@@ -7,6 +7,12 @@
 
 #include "cube/RubiksCube.h"
 #include <optional>
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 
 #include <opencv2/core.hpp>
@@ -24,19 +30,192 @@ struct Face {
     Color colors[3][3];
 };
 
+//What tryScanFace saw, for the debug windows
+struct ScanDebugImages {
+    cv::Mat canny;
+    cv::Mat drawing;
+};
+
+/*
+ * The images and buffers tryScanFace works in. They keep their memory from one frame to the next, so after the first
+ * frame detection only allocates inside OpenCV's contour finder. One context per thread.
+ */
+struct FaceScanContext {
+    FaceScanContext();
+
+    cv::Mat grayFrame;
+    cv::Mat blurredFrame;
+    cv::Mat cannyFrame;
+    cv::Mat dilatedFrame;
+    cv::Mat kernel;
+    //Frame sized, but only the bounding box of the sticker being measured is touched
+    cv::Mat mask;
+
+    std::vector<std::vector<cv::Point>> contours;
+    std::vector<cv::Vec4i> hierarchy;
+    std::vector<cv::Point> convexHull;
+    std::vector<cv::Point> approx;
+
+    //The contours that look like stickers and their centers, computed once per frame
+    std::vector<int> stickers;
+    std::vector<cv::Point> centers;
+    std::vector<int> neighborCounts;
+    std::vector<int> centerNeighbors;
+};
+
+//Looks for the 9 stickers of a face in frame. Doesn't show anything, so it can run on any thread. Debug images are only
+//drawn when debug isn't null
+std::optional<Face> tryScanFace(cv::Mat& frame, FaceScanContext& context, ScanDebugImages* debug = nullptr);
+//The cube the six scanned faces most likely belong to, faces are indexed by Side
+RubiksCube constructCube(Face faces[6]);
+
+//The middle of the frame, where the user is asked to hold the face
+cv::Rect getScanArea(const cv::Mat& frame);
+
+//h in degrees, s and v out of 100
+struct HSVColor {
+    int h;
+    int s;
+    int v;
+};
+
+HSVColor rgbToHsv(Color rgb);
+//How far apart two sticker colors are, hue is ignored when both are close to gray
+double getDistance(HSVColor hsvA, HSVColor hsvB);
+
+//Lower case names of the sides, indexed by Side
+extern std::string SIDE_NAMES[6];
+
+/*
+ * Frames on their way from the capture thread to the detection thread. The ring holds at most capacity frames, pushing
+ * into a full ring drops the oldest one and the detector always takes the newest, skipping the rest. A slow detector
+ * therefore works on what the camera sees now instead of falling further and further behind.
+ */
+class FrameRing {
+public:
+    explicit FrameRing(int capacity);
+
+    void push(cv::Mat frame);
+    //Waits for a frame, nothing once the ring has been closed
+    std::optional<cv::Mat> popLatest();
+    void close();
+
+    //Frames that were never looked at
+    uint64_t getDropped();
+
+private:
+    std::vector<cv::Mat> frames;
+    //Index of the oldest frame
+    int head = 0;
+    int count = 0;
+    bool closed = false;
+    uint64_t dropped = 0;
+
+    std::mutex mutex;
+    std::condition_variable frameAvailable;
+};
+
+//One frame after face detection, handed to the render thread
+struct ScanResult {
+    cv::Mat frame;
+    //The part of the frame that was searched for a face
+    cv::Rect area;
+    std::optional<Face> face;
+    ScanDebugImages debug;
+    double detectionMillis = 0;
+};
+
+/*
+ * Fuses the detections of one face over consecutive frames. Every sticker keeps its last few colors and is estimated by
+ * their per channel median, so a frame smeared by motion blur or caught in a reflection is outvoted instead of being
+ * the one that gets accepted. A detection that disagrees with the estimate on several stickers is dropped, a few of them
+ * in a row mean a different face (or the same one turned) is being held up and the accumulator starts over.
+ */
+class FaceAccumulator {
+public:
+    //Samples kept per sticker, also how many agreeing frames full confidence takes
+    static constexpr int WINDOW = 15;
+    //Stickers further than this from their estimate (by getDistance) don't agree with it
+    static constexpr double AGREE_DISTANCE = 30;
+    //A detection with this many disagreeing stickers doesn't belong to the estimate
+    static constexpr int MISMATCH_STICKERS = 3;
+    //Consecutive mismatching detections before it's taken to be another face
+    static constexpr int RESTART_FRAMES = 5;
+
+    //False if the detection didn't fit the estimate, it was either dropped or the accumulator started over with it
+    bool add(const Face& face);
+    void reset();
+
+    //Nothing before the first detection
+    std::optional<Face> getFace() const;
+    //0 to 1, the share of the window agreeing with the estimate for the least certain sticker
+    double getConfidence() const;
+    int getNumSamples() const;
+
+private:
+    Face samples[WINDOW];
+    //Where the next sample goes
+    int next = 0;
+    int count = 0;
+    int mismatches = 0;
+
+    Face estimate;
+    double confidence = 0;
+
+    void update();
+};
+
+/*
+ * Scans the six faces of a cube with the camera. Reading the camera and finding faces happen on their own threads,
+ * connected by a FrameRing, so tick only has to show the newest result and handle keys. The render loop is never held
+ * up by the camera or by detection.
+ */
 class CubeScanner {
 public:
-    CubeScanner();
+    //Faces are accepted as soon as the accumulated colors reach this confidence, Enter still accepts earlier
+    static constexpr double AUTO_ADVANCE_CONFIDENCE = 0.8;
+
+    //The canny and contour windows cost an allocation and a copy per frame, so they're off unless asked for
+    explicit CubeScanner(bool showDebugWindows = false, bool autoAdvance = true);
     ~CubeScanner();
 
+    //The threads point back at the scanner
+    CubeScanner(const CubeScanner&) = delete;
+    CubeScanner& operator=(const CubeScanner&) = delete;
+
+    //Called once per frame by the render loop, returns the cube once the last face is accepted
     std::optional<RubiksCube> tick();
     Color getSideColor(Side side, RubiksCube& cube);
 private:
     cv::VideoCapture camera;
+    bool showDebugWindows;
 
-    std::optional<Face> currFace = std::nullopt;
+    FrameRing frameRing{2};
+    //Only used by the detection thread
+    FaceScanContext scanContext;
+    std::atomic<bool> running = true;
+    std::thread captureThread;
+    std::thread detectionThread;
+
+    //Newest result the render thread hasn't picked up yet
+    std::mutex resultMutex;
+    std::optional<ScanResult> latestResult;
+
+    bool autoAdvance;
+    FaceAccumulator currFace;
     int currFaceIdx = 0;
     Face faces[6];
+
+    //constructCube can take a moment when the colors don't form a solvable cube, so it runs on its own thread once the
+    //last face is in. Declared last, so it's waited for before the faces it reads go away
+    std::future<RubiksCube> constructedCube;
+
+    void captureLoop();
+    void detectionLoop();
+    //Stores the current face and moves on, starts working out the cube once all six are in
+    void acceptFace();
+    //Whether the face's center matches one that was already accepted, i.e. the user hasn't turned the cube yet
+    bool isAlreadyScanned(const Face& face);
 };
 
 
@@ -3,6 +3,8 @@
 //
 
 #include "CuberConnection.h"
+
+#ifdef _WIN32
 #include <iostream>
 #include <ws2tcpip.h>
 
@@ -66,6 +68,12 @@ void CuberConnection::tick() {
 
     if (!active) return;
 
+    //The socket buffers what the robot sends meanwhile, so waiting for the render loop to catch up loses nothing
+    if (pendingMove) {
+        if (!movesExecuted.push(*pendingMove)) return;
+        pendingMove.reset();
+    }
+
     while (true) {
         auto packet = readPacket();
 
@@ -79,7 +87,12 @@ void CuberConnection::tick() {
         } else if (packetType == 5) {
             std::string inst = std::string((char*)packet.value().data + 1, packet.value().size - 1);
             std::cout << "Executing instruction " << inst << std::endl;
-            movesExecuted.push(Move::fromString(inst));
+
+            RobotMove move = {robotInfo.id, Move::fromString(inst)};
+            if (!movesExecuted.push(move)) {
+                pendingMove = move;
+                break;
+            }
         } else {
             std::cout << "Received unknown packet type: " << packetType << std::endl;
         }
@@ -119,6 +132,7 @@ void CuberConnection::acceptClient() {
         inet_ntop(AF_INET, &clientAddr.sin_addr, ip, INET_ADDRSTRLEN);
         std::cout << "Client connected: " << ip << std::endl;
 
+        robotInfo = {nextRobotId++, ip};
         active = true;
     }
 }
@@ -239,6 +253,11 @@ bool CuberConnection::isActive() {
     return active;
 }
 
+std::vector<RobotInfo> CuberConnection::getRobots() {
+    if (!active) return {};
+    return {robotInfo};
+}
+
 void CuberConnection::resetRobot() {
     //Send packet containing only '\x01'
 
@@ -273,3 +292,5 @@ void CuberConnection::doMoves(std::string moves) {
     sendall((char*) &type, 1);
     sendall(moves.c_str(), moves.length());
 }
+
+#endif
@@ -6,13 +6,44 @@
 #define RUBIK_CUBERCONNECTION_H
 
 #include <string>
-#include <queue>
 #include "common.h"
+#include "util/SpscQueue.h"
 
 #include <cstdio>
-#include <winsock2.h>
 #include <optional>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#endif
+
+//A move a robot reported doing, robot is the id getRobots lists it under
+struct RobotMove {
+    int robot;
+    Move move;
+};
+
+struct RobotInfo {
+    //Never reused, so moves of a robot that reconnected aren't taken for the old connection's
+    int id;
+    std::string address;
+};
 
+/*
+ * Listens for the robot and talks to it. Packets in both directions are a native int length followed by that many
+ * bytes, the first of which is the packet type.
+ *
+ * On Windows the connection is polled with select from tick, one robot at a time. Elsewhere (CuberConnectionPosix.cpp)
+ * non-blocking sockets are driven by an epoll loop on an I/O thread. Any number of robots can be connected there and
+ * the moves sent are given to all of them, tick has nothing left to do. Every robot reports the moves it does, so
+ * movesExecuted says which robot each one came from.
+ */
 class CuberConnection {
 public:
     CuberConnection(std::string ip, int port);
@@ -39,8 +70,18 @@ public:
         return listening;
     }
 
-    std::queue<Move> movesExecuted;
+    //The connected robots, oldest connection first
+    std::vector<RobotInfo> getRobots();
+
+    //Filled by whichever thread reads the sockets, emptied by the render loop
+    SpscQueue<RobotMove, 1024> movesExecuted;
 private:
+    std::string ip;
+    int port;
+
+    bool listening = false;
+
+#ifdef _WIN32
     struct Packet {
 
         int size;
@@ -58,14 +99,12 @@ private:
         }
     };
 
-    std::string ip;
-    int port;
-
     SOCKET listener;
 
-    bool listening = false;
     bool active = false;
     SOCKET client;
+    RobotInfo robotInfo;
+    int nextRobotId = 0;
 
     int sizeBuffer;
     int sizeBufferPos = 0;
@@ -73,12 +112,67 @@ private:
     void* dataBuffer = nullptr;
     int dataBufferPos = 0;
 
+    //A move that didn't fit in movesExecuted, nothing more is read until it does
+    std::optional<RobotMove> pendingMove;
+
     void acceptClient();
 
     bool hasIncomingData();
     std::optional<CuberConnection::Packet> readPacket();
 
     void sendall(const char* data, int size);
+#else
+    struct Client {
+        int fd;
+        int id;
+        std::string address;
+
+        //Everything received that doesn't make up a whole packet yet
+        std::vector<unsigned char> readBuffer;
+        //Everything the socket hasn't taken yet, from writePos on
+        std::vector<unsigned char> writeBuffer;
+        size_t writePos = 0;
+
+        //Packets are left in readBuffer and the socket isn't read while movesExecuted is full, so TCP slows the
+        //robot down instead of moves being lost
+        bool backlogged = false;
+        //What epoll is currently watching the socket for
+        uint32_t events = 0;
+    };
+
+    int listener = -1;
+    int epollFd = -1;
+    //eventfd that wakes the I/O thread when there is something to send or it has to stop
+    int wakeFd = -1;
+
+    std::thread ioThread;
+    std::atomic<bool> stopping = false;
+    std::atomic<int> numClients = 0;
+    //Only touched by the I/O thread
+    int numBacklogged = 0;
+    int nextRobotId = 0;
+
+    //Only the I/O thread adds and removes clients, the render thread appends to their write buffers
+    std::mutex clientsMutex;
+    std::unordered_map<int, Client> clients;
+
+    void stopIo();
+    void ioLoop();
+
+    //These expect clientsMutex to be held
+    void acceptClients();
+    //False once the client is gone or has to be dropped
+    bool readClient(Client& client);
+    bool handlePackets(Client& client);
+    bool flushClient(Client& client);
+    void updateEvents(Client& client);
+    void closeClient(int fd);
+    //False if the packet has to wait for room in movesExecuted
+    bool handlePacket(Client& client, const unsigned char* data, int size);
+
+    //Queues a packet for every robot and wakes the I/O thread to send it
+    void broadcast(const std::string& packet);
+#endif
 };
 
 
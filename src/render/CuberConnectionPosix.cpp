@@ -0,0 +1,421 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#include "CuberConnection.h"
+
+#ifndef _WIN32
+#include <algorithm>
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+//Same limit as the Windows side, anything bigger is a broken robot
+const int MAX_PACKET_SIZE = 1000000;
+//How often a backlogged robot's packets are retried while the render loop catches up
+const int BACKLOG_RETRY_MILLIS = 5;
+
+CuberConnection::CuberConnection(std::string ip, int port) {
+    this->reconfigure(ip, port);
+}
+
+CuberConnection::~CuberConnection() {
+    stopIo();
+}
+
+void CuberConnection::reconfigure(std::string newIp, int newPort) {
+    stopIo();
+
+    this->ip = newIp;
+    this->port = newPort;
+
+    listening = false;
+
+    if ((listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) == -1) {
+        std::cout << "Could not create socket: " << strerror(errno) << std::endl;
+        return;
+    }
+
+    //Otherwise listening on the same port again after a reconfigure fails until the old connections time out
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in server{};
+    server.sin_family = AF_INET;
+    server.sin_port = htons(this->port);
+
+    if (inet_pton(AF_INET, this->ip.c_str(), &server.sin_addr.s_addr) != 1) {
+        std::cout << "Invalid address: " << this->ip << std::endl;
+        stopIo();
+        return;
+    }
+
+    if (bind(listener, (sockaddr *) &server, sizeof(server)) == -1) {
+        std::cout << "Bind failed: " << strerror(errno) << std::endl;
+        stopIo();
+        return;
+    }
+
+    if (listen(listener, SOMAXCONN) == -1) {
+        std::cout << "Listen failed: " << strerror(errno) << std::endl;
+        stopIo();
+        return;
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (epollFd == -1 || wakeFd == -1) {
+        std::cout << "Could not create the event loop: " << strerror(errno) << std::endl;
+        stopIo();
+        return;
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+
+    event.data.fd = listener;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listener, &event);
+    event.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+
+    std::cout << "Listening for connections on " << this->ip << ":" << this->port << std::endl;
+
+    listening = true;
+    stopping = false;
+    ioThread = std::thread(&CuberConnection::ioLoop, this);
+}
+
+void CuberConnection::stopIo() {
+    if (ioThread.joinable()) {
+        stopping = true;
+
+        uint64_t one = 1;
+        write(wakeFd, &one, sizeof(one));
+
+        ioThread.join();
+    }
+
+    for (auto& [fd, client]: clients) {
+        close(fd);
+    }
+    clients.clear();
+    numClients = 0;
+    numBacklogged = 0;
+
+    for (int* fd: {&listener, &epollFd, &wakeFd}) {
+        if (*fd != -1) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+void CuberConnection::ioLoop() {
+    epoll_event events[64];
+
+    while (!stopping) {
+        int count = epoll_wait(epollFd, events, 64, numBacklogged > 0 ? BACKLOG_RETRY_MILLIS : -1);
+
+        if (count == -1) {
+            if (errno == EINTR) continue;
+
+            std::cout << "Epoll failed: " << strerror(errno) << std::endl;
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(clientsMutex);
+
+        for (int i = 0; i < count; i++) {
+            int fd = events[i].data.fd;
+            uint32_t flags = events[i].events;
+
+            if (fd == wakeFd) {
+                uint64_t wakes;
+                read(wakeFd, &wakes, sizeof(wakes));
+
+                //Whatever broadcast queued up
+                std::vector<int> failed;
+                for (auto& [clientFd, client]: clients) {
+                    if (!flushClient(client)) failed.push_back(clientFd);
+                }
+                for (int clientFd: failed) {
+                    closeClient(clientFd);
+                }
+                continue;
+            }
+
+            if (fd == listener) {
+                acceptClients();
+                continue;
+            }
+
+            auto it = clients.find(fd);
+            //Closed by an earlier event of this batch
+            if (it == clients.end()) continue;
+
+            //Read before giving up on a hung up socket, the last packets may still be in it
+            bool alive = true;
+            if (flags & EPOLLIN) alive = readClient(it->second);
+            if (alive && (flags & EPOLLOUT)) alive = flushClient(it->second);
+            if (alive && (flags & (EPOLLHUP | EPOLLERR))) {
+                std::cout << "Robot " << it->second.address << " disconnected" << std::endl;
+                alive = false;
+            }
+
+            if (!alive) {
+                closeClient(fd);
+            }
+        }
+
+        if (numBacklogged > 0) {
+            std::vector<int> failed;
+            for (auto& [fd, client]: clients) {
+                if (client.backlogged && !handlePackets(client)) failed.push_back(fd);
+            }
+            for (int fd: failed) {
+                closeClient(fd);
+            }
+        }
+    }
+}
+
+void CuberConnection::acceptClients() {
+    while (true) {
+        sockaddr_in clientAddr;
+        socklen_t clientAddrSize = sizeof(clientAddr);
+
+        int fd = accept4(listener, (sockaddr *) &clientAddr, &clientAddrSize, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (fd == -1) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cout << "Accept failed: " << strerror(errno) << std::endl;
+            }
+            return;
+        }
+
+        char address[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &clientAddr.sin_addr, address, INET_ADDRSTRLEN);
+
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = fd;
+
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == -1) {
+            std::cout << "Could not watch robot " << address << ": " << strerror(errno) << std::endl;
+            close(fd);
+            continue;
+        }
+
+        Client& client = clients[fd];
+        client.fd = fd;
+        client.id = nextRobotId++;
+        client.events = event.events;
+        client.address = std::string(address) + ":" + std::to_string(ntohs(clientAddr.sin_port));
+        numClients++;
+
+        std::cout << "Robot connected: " << client.address << std::endl;
+    }
+}
+
+bool CuberConnection::readClient(Client& client) {
+    unsigned char buffer[4096];
+
+    while (true) {
+        ssize_t result = recv(client.fd, buffer, sizeof(buffer), 0);
+
+        if (result == 0) {
+            //Whatever it sent before hanging up still counts
+            handlePackets(client);
+            std::cout << "Robot " << client.address << " disconnected" << std::endl;
+            return false;
+        }
+
+        if (result == -1) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+
+            std::cout << "Recv from " << client.address << " failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        client.readBuffer.insert(client.readBuffer.end(), buffer, buffer + result);
+    }
+
+    return handlePackets(client);
+}
+
+bool CuberConnection::handlePackets(Client& client) {
+    bool wasBacklogged = client.backlogged;
+    client.backlogged = false;
+
+    //Hand on every whole packet, the rest waits for more data
+    size_t pos = 0;
+    while (client.readBuffer.size() - pos >= sizeof(int)) {
+        int size;
+        memcpy(&size, client.readBuffer.data() + pos, sizeof(size));
+
+        if (size == 0) {
+            std::cout << "Robot " << client.address << " disconnected" << std::endl;
+            return false;
+        }
+
+        if (size < 0 || size > MAX_PACKET_SIZE) {
+            std::cout << "Robot " << client.address << " sent invalid packet size" << std::endl;
+            return false;
+        }
+
+        if (client.readBuffer.size() - pos - sizeof(int) < (size_t) size) break;
+
+        if (!handlePacket(client, client.readBuffer.data() + pos + sizeof(int), size)) {
+            client.backlogged = true;
+            break;
+        }
+        pos += sizeof(int) + size;
+    }
+
+    client.readBuffer.erase(client.readBuffer.begin(), client.readBuffer.begin() + pos);
+
+    if (client.backlogged != wasBacklogged) {
+        numBacklogged += client.backlogged ? 1 : -1;
+        updateEvents(client);
+    }
+
+    return true;
+}
+
+bool CuberConnection::flushClient(Client& client) {
+    while (client.writePos < client.writeBuffer.size()) {
+        //MSG_NOSIGNAL so a robot that went away is an error here instead of a SIGPIPE
+        ssize_t result = send(client.fd, client.writeBuffer.data() + client.writePos, client.writeBuffer.size() - client.writePos, MSG_NOSIGNAL);
+
+        if (result == -1) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+
+            std::cout << "Send to " << client.address << " failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        client.writePos += result;
+    }
+
+    if (client.writePos == client.writeBuffer.size()) {
+        client.writeBuffer.clear();
+        client.writePos = 0;
+    }
+
+    updateEvents(client);
+    return true;
+}
+
+void CuberConnection::updateEvents(Client& client) {
+    //Epoll is level triggered, so a readable socket that isn't being read or a writable one with nothing to write
+    //would wake the loop constantly
+    uint32_t wanted = 0;
+    if (!client.backlogged) wanted |= EPOLLIN | EPOLLRDHUP;
+    if (client.writePos < client.writeBuffer.size()) wanted |= EPOLLOUT;
+
+    if (wanted == client.events) return;
+
+    epoll_event event{};
+    event.events = wanted;
+    event.data.fd = client.fd;
+
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, client.fd, &event);
+    client.events = wanted;
+}
+
+void CuberConnection::closeClient(int fd) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+
+    if (clients[fd].backlogged) numBacklogged--;
+    clients.erase(fd);
+    numClients--;
+}
+
+bool CuberConnection::handlePacket(Client& client, const unsigned char* data, int size) {
+    int packetType = data[0];
+
+    if (packetType == 1) {
+        std::string message = std::string((const char*) data + 1, size - 1);
+        std::cout << "Received message from " << client.address << ": " << message << std::endl;
+    } else if (packetType == 5) {
+        std::string inst = std::string((const char*) data + 1, size - 1);
+        if (!movesExecuted.push({client.id, Move::fromString(inst)})) {
+            return false;
+        }
+
+        std::cout << "Robot " << client.address << " executing instruction " << inst << std::endl;
+    } else {
+        std::cout << "Received unknown packet type: " << packetType << std::endl;
+    }
+
+    return true;
+}
+
+void CuberConnection::broadcast(const std::string& packet) {
+    int length = packet.size();
+
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+
+        for (auto& [fd, client]: clients) {
+            client.writeBuffer.insert(client.writeBuffer.end(), (const unsigned char*) &length, (const unsigned char*) &length + sizeof(length));
+            client.writeBuffer.insert(client.writeBuffer.end(), packet.begin(), packet.end());
+        }
+    }
+
+    if (wakeFd != -1) {
+        uint64_t one = 1;
+        write(wakeFd, &one, sizeof(one));
+    }
+}
+
+void CuberConnection::tick() {
+    //The I/O thread reads and sends on its own, moves show up in movesExecuted without being polled for
+}
+
+bool CuberConnection::isActive() {
+    return numClients > 0;
+}
+
+std::vector<RobotInfo> CuberConnection::getRobots() {
+    std::vector<RobotInfo> robots;
+
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+
+        for (auto& [fd, client]: clients) {
+            robots.push_back({client.id, client.address});
+        }
+    }
+
+    std::sort(robots.begin(), robots.end(), [](const RobotInfo& a, const RobotInfo& b) {
+        return a.id < b.id;
+    });
+    return robots;
+}
+
+void CuberConnection::resetRobot() {
+    //Packet containing only '\x01'
+    broadcast(std::string(1, '\x01'));
+}
+
+void CuberConnection::doMoves(std::string moves) {
+    std::cout << "Sending the following algorithm: \'" << moves << "\'" << std::endl;
+
+    //Type 0 followed by the moves
+    broadcast(std::string(1, '\0') + moves);
+}
+
+#endif
@@ -0,0 +1,394 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#include "ScannerEvaluation.h"
+#include "CubeScanner.h"
+#include "util/Statistics.h"
+#include "util/WorkStealing.h"
+
+#include <opencv2/imgcodecs.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock ScanClock;
+
+struct FaceRecording {
+    std::string path;
+    int cube;
+    Side side;
+    Side truth[3][3];
+};
+
+struct RecordedCube {
+    std::string name;
+    //Index into the recordings for each side, -1 until its line is read
+    int recordings[6] = {-1, -1, -1, -1, -1, -1};
+};
+
+struct FrameRecord {
+    int frame;
+    std::optional<Face> face;
+    double detectionMs;
+    //Out of 9, -1 if nothing was detected or the cube couldn't be put together
+    int correctStickers = -1;
+};
+
+struct RecordingResult {
+    bool opened = false;
+    std::vector<FrameRecord> frames;
+    //The face the scanner would have accepted, fused over the frames up to acceptedFrame or over all of them if it
+    //never got confident enough
+    std::optional<Face> acceptedFace;
+    int acceptedFrame = -1;
+};
+
+static Side parseSticker(char c, const std::string& line) {
+    const std::string STICKERS = "FBLRUD";
+    size_t index = STICKERS.find(c);
+
+    if (index == std::string::npos) {
+        std::cerr << "Unknown sticker '" << c << "' in manifest line: " << line << std::endl;
+        exit(1);
+    }
+
+    return (Side) index;
+}
+
+static void readManifest(const std::string& path, std::vector<RecordedCube>& cubes, std::vector<FaceRecording>& recordings) {
+    std::ifstream in(path);
+
+    if (!in) {
+        std::cerr << "Couldn't open " << path << std::endl;
+        exit(1);
+    }
+
+    //Recordings are relative to the manifest
+    std::filesystem::path base = std::filesystem::path(path).parent_path();
+
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream tokens(line);
+        std::string first;
+
+        if (!(tokens >> first) || first[0] == '#') continue;
+
+        if (first == "cube") {
+            RecordedCube cube;
+            tokens >> cube.name;
+            cubes.push_back(cube);
+            continue;
+        }
+
+        if (cubes.empty()) {
+            std::cerr << "Manifest line before the first cube: " << line << std::endl;
+            exit(1);
+        }
+
+        int side = std::find(SIDE_NAMES, SIDE_NAMES + 6, first) - SIDE_NAMES;
+        std::string file, stickers;
+
+        if (side == 6 || !(tokens >> file >> stickers) || stickers.size() != 9) {
+            std::cerr << "Expected <side> <recording> <9 stickers>: " << line << std::endl;
+            exit(1);
+        }
+
+        FaceRecording recording;
+        recording.path = (base / file).string();
+        recording.cube = cubes.size() - 1;
+        recording.side = (Side) side;
+
+        for (int i = 0; i < 9; i++) {
+            recording.truth[i / 3][i % 3] = parseSticker(stickers[i], line);
+        }
+
+        cubes.back().recordings[side] = recordings.size();
+        recordings.push_back(recording);
+    }
+}
+
+//Calls onFrame for every frame of a video, or every image of a directory in name order. False if nothing could be read
+static bool forEachFrame(const std::string& path, const std::function<void(cv::Mat&)>& onFrame) {
+    if (std::filesystem::is_directory(path)) {
+        std::vector<std::filesystem::path> images;
+
+        for (const auto& entry: std::filesystem::directory_iterator(path)) {
+            std::string extension = entry.path().extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+            if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp") {
+                images.push_back(entry.path());
+            }
+        }
+
+        std::sort(images.begin(), images.end());
+
+        for (const auto& image: images) {
+            cv::Mat frame = cv::imread(image.string(), cv::IMREAD_COLOR);
+
+            if (frame.empty()) {
+                std::cerr << "Couldn't read " << image.string() << std::endl;
+                continue;
+            }
+
+            onFrame(frame);
+        }
+
+        return !images.empty();
+    }
+
+    cv::VideoCapture video(path);
+    if (!video.isOpened()) {
+        return false;
+    }
+
+    cv::Mat frame;
+    while (video.read(frame) && !frame.empty()) {
+        onFrame(frame);
+    }
+
+    return true;
+}
+
+static void scanRecording(const FaceRecording& recording, RecordingResult& result) {
+    FaceScanContext context;
+    FaceAccumulator accumulator;
+    int frameIndex = 0;
+
+    result.opened = forEachFrame(recording.path, [&](cv::Mat& frame) {
+        //Same crop the live scanner searches
+        auto start = ScanClock::now();
+        cv::Mat cropped = frame(getScanArea(frame));
+        std::optional<Face> face = tryScanFace(cropped, context);
+        double ms = std::chrono::duration<double, std::milli>(ScanClock::now() - start).count();
+
+        if (face && result.acceptedFrame == -1) {
+            accumulator.add(*face);
+            result.acceptedFace = accumulator.getFace();
+
+            if (accumulator.getConfidence() >= CubeScanner::AUTO_ADVANCE_CONFIDENCE) {
+                result.acceptedFrame = frameIndex;
+            }
+        }
+
+        result.frames.push_back({frameIndex++, face, ms});
+    });
+
+    if (!result.opened) {
+        std::cerr << "Couldn't open " << recording.path << std::endl;
+    }
+}
+
+//The side whose center color is closest, the way constructCube ranks them but without counting pieces
+static Side classifySticker(Color color, const HSVColor centers[6]) {
+    HSVColor hsv = rgbToHsv(color);
+
+    int best = 0;
+    for (int k = 1; k < 6; k++) {
+        if (getDistance(hsv, centers[k]) < getDistance(hsv, centers[best])) {
+            best = k;
+        }
+    }
+
+    return (Side) best;
+}
+
+static std::string escapeJSON(const std::string& text) {
+    std::string out;
+    for (char c: text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+static void writeCSV(const std::string& path, const std::vector<FaceRecording>& recordings, const std::vector<RecordingResult>& results) {
+    std::ofstream out(path);
+
+    if (!out) {
+        std::cerr << "Couldn't open " << path << std::endl;
+        exit(1);
+    }
+
+    out << "Recording,Side,Frame,Detected,Detection (ms),Correct stickers" << std::endl;
+
+    for (size_t i = 0; i < recordings.size(); i++) {
+        for (const FrameRecord& frame: results[i].frames) {
+            out << recordings[i].path << "," << SIDE_NAMES[recordings[i].side] << "," << frame.frame << ","
+                << (frame.face ? 1 : 0) << "," << frame.detectionMs << "," << frame.correctStickers << std::endl;
+        }
+    }
+}
+
+void runScannerEvaluation(const ScannerEvaluationConfig& config) {
+    int numThreads = config.numThreads > 0 ? config.numThreads : (int) std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<RecordedCube> cubes;
+    std::vector<FaceRecording> recordings;
+    readManifest(config.manifestPath, cubes, recordings);
+
+    std::vector<RecordingResult> results(recordings.size());
+    auto start = ScanClock::now();
+
+    runWorkStealing(numThreads, (int) recordings.size(), [&](int i) {
+        scanRecording(recordings[i], results[i]);
+    });
+
+    double wallSeconds = std::chrono::duration<double>(ScanClock::now() - start).count();
+
+    //Put every cube together from the faces the scanner would have accepted, then check frames against its centers
+    int cubesConstructed = 0;
+    int cubesSolvable = 0;
+    int cubesCorrect = 0;
+    int cubeStickers = 0;
+    int cubeStickersCorrect = 0;
+
+    for (const RecordedCube& cube: cubes) {
+        Face faces[6];
+        bool complete = true;
+
+        for (int side = 0; side < 6; side++) {
+            int recording = cube.recordings[side];
+
+            if (recording == -1 || !results[recording].acceptedFace) {
+                complete = false;
+                break;
+            }
+
+            faces[side] = *results[recording].acceptedFace;
+        }
+
+        if (!complete) {
+            std::cout << "Cube " << cube.name << " is missing a face, skipping its accuracy" << std::endl;
+            continue;
+        }
+
+        HSVColor centers[6];
+        for (int side = 0; side < 6; side++) {
+            centers[side] = rgbToHsv(faces[side].colors[1][1]);
+        }
+
+        for (int side = 0; side < 6; side++) {
+            const FaceRecording& recording = recordings[cube.recordings[side]];
+
+            for (FrameRecord& frame: results[cube.recordings[side]].frames) {
+                if (!frame.face) continue;
+
+                frame.correctStickers = 0;
+                for (int i = 0; i < 3; i++) {
+                    for (int j = 0; j < 3; j++) {
+                        if (classifySticker(frame.face->colors[i][j], centers) == recording.truth[i][j]) {
+                            frame.correctStickers++;
+                        }
+                    }
+                }
+            }
+        }
+
+        RubiksCube constructed = constructCube(faces);
+        cubesConstructed++;
+        if (constructed.isSolvable()) cubesSolvable++;
+
+        int correct = 0;
+        for (int side = 0; side < 6; side++) {
+            const FaceRecording& recording = recordings[cube.recordings[side]];
+
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 3; j++) {
+                    if (constructed.sides[side][i][j] == recording.truth[i][j]) {
+                        correct++;
+                    }
+                }
+            }
+        }
+
+        cubeStickers += 54;
+        cubeStickersCorrect += correct;
+        if (correct == 54) cubesCorrect++;
+    }
+
+    writeCSV(config.csvPath, recordings, results);
+
+    std::ofstream out(config.jsonPath);
+
+    if (!out) {
+        std::cerr << "Couldn't open " << config.jsonPath << std::endl;
+        exit(1);
+    }
+
+    int totalFrames = 0;
+    int detectedFrames = 0;
+    int checkedStickers = 0;
+    int correctStickers = 0;
+    int autoAccepted = 0;
+    std::vector<double> detectionTimes;
+    std::vector<double> framesToAccept;
+
+    for (const RecordingResult& result: results) {
+        if (result.acceptedFrame != -1) {
+            autoAccepted++;
+            framesToAccept.push_back(result.acceptedFrame + 1);
+        }
+
+        for (const FrameRecord& frame: result.frames) {
+            totalFrames++;
+            detectionTimes.push_back(frame.detectionMs);
+
+            if (frame.face) detectedFrames++;
+            if (frame.correctStickers != -1) {
+                checkedStickers += 9;
+                correctStickers += frame.correctStickers;
+            }
+        }
+    }
+
+    std::sort(detectionTimes.begin(), detectionTimes.end());
+    std::sort(framesToAccept.begin(), framesToAccept.end());
+
+    out << "{" << std::endl;
+    out << "  \"cubes\": " << cubes.size() << "," << std::endl;
+    out << "  \"recordings\": " << recordings.size() << "," << std::endl;
+    out << "  \"threads\": " << numThreads << "," << std::endl;
+    out << "  \"wall_seconds\": " << wallSeconds << "," << std::endl;
+    out << "  \"frames\": " << totalFrames << "," << std::endl;
+    out << "  \"frames_per_second\": " << (wallSeconds > 0 ? totalFrames / wallSeconds : 0) << "," << std::endl;
+    out << "  \"detection_rate\": " << (totalFrames ? (double) detectedFrames / totalFrames : 0) << "," << std::endl;
+    out << "  \"detection_ms\": {\"p50\": " << percentile(detectionTimes, 0.5) << ", \"p90\": " << percentile(detectionTimes, 0.9)
+        << ", \"p99\": " << percentile(detectionTimes, 0.99) << ", \"max\": " << percentile(detectionTimes, 1) << "}," << std::endl;
+    //Every sticker of every detected frame, classified by the nearest center
+    out << "  \"frame_sticker_accuracy\": " << (checkedStickers ? (double) correctStickers / checkedStickers : -1) << "," << std::endl;
+    //How long the scanner's auto advance would have waited on each face
+    out << "  \"faces_auto_accepted\": " << autoAccepted << "," << std::endl;
+    out << "  \"frames_to_accept\": {\"p50\": " << percentile(framesToAccept, 0.5) << ", \"p90\": " << percentile(framesToAccept, 0.9)
+        << ", \"max\": " << percentile(framesToAccept, 1) << "}," << std::endl;
+    out << "  \"cubes_constructed\": " << cubesConstructed << "," << std::endl;
+    out << "  \"cubes_solvable\": " << cubesSolvable << "," << std::endl;
+    out << "  \"cubes_correct\": " << cubesCorrect << "," << std::endl;
+    out << "  \"cube_sticker_accuracy\": " << (cubeStickers ? (double) cubeStickersCorrect / cubeStickers : -1) << "," << std::endl;
+
+    out << "  \"per_recording\": [";
+    for (size_t i = 0; i < recordings.size(); i++) {
+        int detected = 0;
+        for (const FrameRecord& frame: results[i].frames) {
+            if (frame.face) detected++;
+        }
+
+        if (i) out << ",";
+        out << std::endl << "    {\"path\": \"" << escapeJSON(recordings[i].path) << "\", \"opened\": " << (results[i].opened ? "true" : "false")
+            << ", \"frames\": " << results[i].frames.size() << ", \"detected\": " << detected << ", \"accepted_frame\": " << results[i].acceptedFrame << "}";
+    }
+    out << std::endl << "  ]" << std::endl;
+    out << "}" << std::endl;
+
+    std::cout << "Scanned " << totalFrames << " frames from " << recordings.size() << " recordings in " << wallSeconds << "s, "
+              << cubesCorrect << "/" << cubes.size() << " cubes correct, results in " << config.csvPath << " and " << config.jsonPath << std::endl;
+}
@@ -0,0 +1,36 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_SCANNEREVALUATION_H
+#define RUBIK_SCANNEREVALUATION_H
+
+#include <string>
+
+/*
+ * Runs the scanner over recorded faces instead of the live camera, so detection speed and color accuracy can be
+ * compared between commits on machines without one. The manifest lists the recordings of each cube:
+ *
+ *   # comment
+ *   cube <name>
+ *   <side> <video file or image directory> <9 stickers row by row, as F B L R U D>
+ *   ... one line for each of the six sides
+ *
+ * Sides are named like SIDE_NAMES, a sticker is written as the side whose center has its color. Recordings are
+ * decoded and scanned in parallel, one per thread. Every frame is written to a CSV file and the summary (detection
+ * rate, detection latency, frames until a face is confident enough to be accepted, sticker accuracy per frame and after
+ * constructCube) to a JSON file.
+ */
+
+struct ScannerEvaluationConfig {
+    std::string manifestPath;
+    //0 for one per core
+    int numThreads = 0;
+
+    std::string csvPath = "scanner_evaluation.csv";
+    std::string jsonPath = "scanner_evaluation.json";
+};
+
+void runScannerEvaluation(const ScannerEvaluationConfig& config);
+
+#endif //RUBIK_SCANNEREVALUATION_H
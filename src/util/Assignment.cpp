@@ -0,0 +1,155 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#include "Assignment.h"
+
+#include <limits>
+#include <queue>
+#include <utility>
+
+std::vector<int> solveAssignment(const std::vector<double>& cost, int n, double* totalCost) {
+    const double INF = std::numeric_limits<double>::infinity();
+
+    //Potentials and the column matched to each row, 1 based with row 0 and column 0 as the sentinel
+    std::vector<double> u(n + 1, 0), v(n + 1, 0);
+    std::vector<int> rowOf(n + 1, 0), way(n + 1, 0);
+    std::vector<double> minSlack(n + 1);
+    std::vector<bool> used(n + 1);
+
+    for (int row = 1; row <= n; row++) {
+        rowOf[0] = row;
+        int col0 = 0;
+
+        std::fill(minSlack.begin(), minSlack.end(), INF);
+        std::fill(used.begin(), used.end(), false);
+
+        do {
+            used[col0] = true;
+            int row0 = rowOf[col0];
+            double delta = INF;
+            int col1 = 0;
+
+            for (int col = 1; col <= n; col++) {
+                if (used[col]) continue;
+
+                double slack = cost[(row0 - 1) * n + (col - 1)] - u[row0] - v[col];
+                if (slack < minSlack[col]) {
+                    minSlack[col] = slack;
+                    way[col] = col0;
+                }
+
+                if (minSlack[col] < delta) {
+                    delta = minSlack[col];
+                    col1 = col;
+                }
+            }
+
+            for (int col = 0; col <= n; col++) {
+                if (used[col]) {
+                    u[rowOf[col]] += delta;
+                    v[col] -= delta;
+                } else {
+                    minSlack[col] -= delta;
+                }
+            }
+
+            col0 = col1;
+        } while (rowOf[col0] != 0);
+
+        //Flip the augmenting path
+        do {
+            int col1 = way[col0];
+            rowOf[col0] = rowOf[col1];
+            col0 = col1;
+        } while (col0);
+    }
+
+    std::vector<int> assignment(n);
+    double total = 0;
+
+    for (int col = 1; col <= n; col++) {
+        int row = rowOf[col] - 1;
+        assignment[row] = col - 1;
+        total += cost[row * n + col - 1];
+
+        if (cost[row * n + col - 1] >= ASSIGNMENT_FORBIDDEN) {
+            return {};
+        }
+    }
+
+    if (totalCost) *totalCost = total;
+    return assignment;
+}
+
+void enumerateAssignments(const std::vector<double>& cost, int n, int maxAssignments, const std::function<bool(const std::vector<int>& assignment, double cost)>& onAssignment) {
+    //A part of the solution space: the matchings with some row/column pairs forced or forbidden, and its best matching.
+    //Only the pairs are stored, the cost matrix is rebuilt from them when the subproblem is solved
+    struct Subproblem {
+        std::vector<std::pair<int, int>> forced;
+        std::vector<std::pair<int, int>> forbidden;
+        std::vector<int> assignment;
+        double total = 0;
+
+        bool operator<(const Subproblem& other) const {
+            return total > other.total;
+        }
+    };
+
+    std::vector<double> constrained(cost.size());
+    auto solve = [&](Subproblem& sub) {
+        constrained = cost;
+
+        for (auto [row, col]: sub.forced) {
+            for (int other = 0; other < n; other++) {
+                if (other != col) constrained[row * n + other] = ASSIGNMENT_FORBIDDEN;
+                if (other != row) constrained[other * n + col] = ASSIGNMENT_FORBIDDEN;
+            }
+        }
+        for (auto [row, col]: sub.forbidden) {
+            constrained[row * n + col] = ASSIGNMENT_FORBIDDEN;
+        }
+
+        sub.assignment = solveAssignment(constrained, n, &sub.total);
+        return !sub.assignment.empty();
+    };
+
+    std::priority_queue<Subproblem> queue;
+
+    Subproblem first;
+    if (!solve(first)) return;
+    queue.push(std::move(first));
+
+    std::vector<bool> rowForced(n);
+
+    for (int found = 0; found < maxAssignments && !queue.empty(); found++) {
+        Subproblem best = queue.top();
+        queue.pop();
+
+        if (!onAssignment(best.assignment, best.total)) return;
+
+        std::fill(rowForced.begin(), rowForced.end(), false);
+        for (auto [row, col]: best.forced) {
+            rowForced[row] = true;
+        }
+
+        //Split what's left into subproblems that keep the first i rows of this matching but differ in row i
+        std::vector<std::pair<int, int>> forced = best.forced;
+        for (int row = 0; row < n; row++) {
+            int col = best.assignment[row];
+
+            //Every matching of this subproblem already uses that pair
+            if (rowForced[row]) continue;
+
+            Subproblem next;
+            next.forced = forced;
+            next.forbidden = best.forbidden;
+            next.forbidden.emplace_back(row, col);
+            if (solve(next)) {
+                queue.push(std::move(next));
+            }
+
+            forced.emplace_back(row, col);
+        }
+    }
+}
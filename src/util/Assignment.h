@@ -0,0 +1,26 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_ASSIGNMENT_H
+#define RUBIK_ASSIGNMENT_H
+
+#include <functional>
+#include <vector>
+
+//Costs at or above this mark a row and column that may not be matched
+const double ASSIGNMENT_FORBIDDEN = 1e9;
+
+/*
+ * Minimum cost perfect matching of an n by n cost matrix (row major) with the Hungarian algorithm, O(n^3). Returns the
+ * column matched to every row, or nothing if only forbidden matchings are left.
+ */
+std::vector<int> solveAssignment(const std::vector<double>& cost, int n, double* totalCost = nullptr);
+
+/*
+ * Every matching in order of increasing cost (Murty's algorithm), each found with one solveAssignment per row. Stops
+ * once onAssignment returns false, maxAssignments have been found or there are no more.
+ */
+void enumerateAssignments(const std::vector<double>& cost, int n, int maxAssignments, const std::function<bool(const std::vector<int>& assignment, double cost)>& onAssignment);
+
+#endif //RUBIK_ASSIGNMENT_H
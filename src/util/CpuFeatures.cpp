@@ -0,0 +1,86 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#include "CpuFeatures.h"
+
+#ifdef RUBIK_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#ifdef RUBIK_X86
+static void cpuid(int leaf, int subleaf, unsigned int regs[4]) {
+#ifdef _MSC_VER
+    int out[4];
+    __cpuidex(out, leaf, subleaf);
+    for (int i = 0; i < 4; i++) {
+        regs[i] = (unsigned int) out[i];
+    }
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static unsigned long long xgetbv() {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long) edx << 32) | eax;
+#endif
+}
+#endif
+
+static CpuFeatures detectCpuFeatures() {
+    CpuFeatures features;
+
+#ifdef RUBIK_X86
+    unsigned int regs[4];
+
+    cpuid(0, 0, regs);
+    unsigned int maxLeaf = regs[0];
+    bool isAmd = regs[1] == 0x68747541; //"Auth" from "AuthenticAMD"
+    unsigned int family = 0;
+    bool osAvx = false;
+    bool osAvx512 = false;
+
+    if (maxLeaf >= 1) {
+        cpuid(1, 0, regs);
+        features.ssse3 = (regs[2] >> 9) & 1;
+        features.sse41 = (regs[2] >> 19) & 1;
+        features.popcnt = (regs[2] >> 23) & 1;
+
+        bool osxsave = (regs[2] >> 27) & 1;
+        if (osxsave) {
+            unsigned long long xcr0 = xgetbv();
+            osAvx = (xcr0 & 0x6) == 0x6;
+            osAvx512 = (xcr0 & 0xE6) == 0xE6;
+        }
+
+        family = (regs[0] >> 8) & 0xF;
+        if (family == 0xF) {
+            family += (regs[0] >> 20) & 0xFF;
+        }
+    }
+
+    if (maxLeaf >= 7) {
+        cpuid(7, 0, regs);
+        features.bmi2 = (regs[1] >> 8) & 1;
+        features.fastPdep = features.bmi2 && (!isAmd || family >= 0x19);
+        features.avx2 = osAvx && ((regs[1] >> 5) & 1);
+        features.avx512 = osAvx512 && ((regs[1] >> 16) & 1) && ((regs[1] >> 30) & 1);
+    }
+#endif
+
+    return features;
+}
+
+const CpuFeatures& getCpuFeatures() {
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
@@ -0,0 +1,38 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_CPUFEATURES_H
+#define RUBIK_CPUFEATURES_H
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RUBIK_X86 1
+#endif
+
+//Lets a single function be compiled for an instruction set the rest of the build doesn't assume.
+//MSVC emits intrinsics regardless of /arch so it doesn't need (or support) the attribute.
+#if defined(RUBIK_X86) && !defined(_MSC_VER)
+#define RUBIK_TARGET(features) __attribute__((target(features)))
+#else
+#define RUBIK_TARGET(features)
+#endif
+
+struct CpuFeatures {
+    bool popcnt = false;
+    bool bmi2 = false;
+
+    //pdep/pext are microcoded on AMD before Zen 3 and end up slower than a plain loop
+    bool fastPdep = false;
+
+    bool ssse3 = false;
+    bool sse41 = false;
+
+    //The AVX flags also require the OS to save the wider registers on context switches
+    bool avx2 = false;
+    bool avx512 = false; //F + BW, which is what the byte kernels need
+};
+
+//Queried once with CPUID, every later call returns the cached result
+const CpuFeatures& getCpuFeatures();
+
+#endif //RUBIK_CPUFEATURES_H
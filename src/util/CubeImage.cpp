@@ -0,0 +1,232 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#include "CubeImage.h"
+#include "WorkStealing.h"
+#include "stb_image_write.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+
+const uint8_t CUBE_IMAGE_COLORS[7][3] = {
+        {255, 0,   0}, //RED
+        {255, 165, 0}, //ORANGE
+        {0,   0,   255}, //BLUE
+        {0,   255, 0}, //GREEN
+        {255, 255, 0}, //YELLOW
+        {255, 255, 255}, //WHITE
+        {0,   0,   0} //BORDER
+};
+
+static const uint8_t BACKGROUND[3] = {51, 77, 77};
+
+Image::Image(int width, int height, const uint8_t background[3]) : width(width), height(height), pixels(width * height * 3) {
+    fillRect(0, 0, width, height, background);
+}
+
+void Image::fillRect(int x, int y, int w, int h, const uint8_t color[3]) {
+    int x0 = std::max(x, 0);
+    int y0 = std::max(y, 0);
+    int x1 = std::min(x + w, width);
+    int y1 = std::min(y + h, height);
+
+    for (int row = y0; row < y1; row++) {
+        uint8_t* p = &pixels[(row * width + x0) * 3];
+
+        for (int col = x0; col < x1; col++) {
+            *p++ = color[0];
+            *p++ = color[1];
+            *p++ = color[2];
+        }
+    }
+}
+
+void Image::fillQuad(const float xs[4], const float ys[4], const uint8_t color[3]) {
+    int x0 = std::max(0, (int) std::floor(*std::min_element(xs, xs + 4)));
+    int x1 = std::min(width - 1, (int) std::ceil(*std::max_element(xs, xs + 4)));
+    int y0 = std::max(0, (int) std::floor(*std::min_element(ys, ys + 4)));
+    int y1 = std::min(height - 1, (int) std::ceil(*std::max_element(ys, ys + 4)));
+
+    //Works for either winding, a pixel is inside when it's on the same side of every edge
+    float area = 0;
+    for (int i = 0; i < 4; i++) {
+        int j = (i + 1) % 4;
+        area += xs[i] * ys[j] - xs[j] * ys[i];
+    }
+    float sign = area < 0 ? -1.0f : 1.0f;
+
+    for (int row = y0; row <= y1; row++) {
+        float py = row + 0.5f;
+
+        for (int col = x0; col <= x1; col++) {
+            float px = col + 0.5f;
+
+            bool inside = true;
+            for (int i = 0; i < 4 && inside; i++) {
+                int j = (i + 1) % 4;
+                float edge = (xs[j] - xs[i]) * (py - ys[i]) - (ys[j] - ys[i]) * (px - xs[i]);
+                inside = edge * sign >= 0;
+            }
+
+            if (inside) {
+                uint8_t* p = &pixels[(row * width + col) * 3];
+                p[0] = color[0];
+                p[1] = color[1];
+                p[2] = color[2];
+            }
+        }
+    }
+}
+
+bool Image::writePNG(const std::string& path) const {
+    return stbi_write_png(path.c_str(), width, height, 3, pixels.data(), width * 3) != 0;
+}
+
+void drawNet(Image& image, const RubiksCube& cube, int x, int y, int squareSize) {
+    //Where each face goes in the net, in faces
+    const int FACE_X[6] = {1, 3, 0, 2, 1, 1};
+    const int FACE_Y[6] = {1, 1, 1, 1, 0, 2};
+
+    for (int face = 0; face < 6; face++) {
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                int squareX = x + (FACE_X[face] * 3 + j) * squareSize;
+                int squareY = y + (FACE_Y[face] * 3 + i) * squareSize;
+
+                image.fillRect(squareX, squareY, squareSize, squareSize, CUBE_IMAGE_COLORS[6]);
+                image.fillRect(squareX + 1, squareY + 1, squareSize - 2, squareSize - 2, CUBE_IMAGE_COLORS[cube.sides[face][i][j]]);
+            }
+        }
+    }
+}
+
+struct FaceAxes {
+    //Outward normal, then the directions the columns (j) and rows (i) of the face go in, as laid out in the net
+    float n[3];
+    float u[3];
+    float v[3];
+};
+
+static const FaceAxes FACE_AXES[6] = {
+        {{0, 0, 1}, {1, 0, 0}, {0, -1, 0}},     //FRONT
+        {{0, 0, -1}, {-1, 0, 0}, {0, -1, 0}},   //BACK
+        {{-1, 0, 0}, {0, 0, 1}, {0, -1, 0}},    //LEFT
+        {{1, 0, 0}, {0, 0, -1}, {0, -1, 0}},    //RIGHT
+        {{0, 1, 0}, {1, 0, 0}, {0, 0, 1}},      //TOP
+        {{0, -1, 0}, {1, 0, 0}, {0, 0, -1}}     //BOTTOM
+};
+
+void drawCubeView(Image& image, const RubiksCube& cube, int x, int y, int size) {
+    //Turned so the right face and then the top face tip towards the viewer
+    const float YAW = -35.0f * 3.14159265f / 180;
+    const float PITCH = 30.0f * 3.14159265f / 180;
+
+    float cy = std::cos(YAW), sy = std::sin(YAW);
+    float cp = std::cos(PITCH), sp = std::sin(PITCH);
+
+    auto rotate = [&](const float p[3], float out[3]) {
+        float x1 = p[0] * cy + p[2] * sy;
+        float z1 = -p[0] * sy + p[2] * cy;
+
+        out[0] = x1;
+        out[1] = p[1] * cp - z1 * sp;
+        out[2] = p[1] * sp + z1 * cp;
+    };
+
+    //The cube is 3 wide, its corners stay within 1.5 * sqrt(3) of the center
+    float scale = size / (3.0f * std::sqrt(3.0f) * 1.05f);
+    float centerX = x + size / 2.0f;
+    float centerY = y + size / 2.0f;
+
+    //Corners of the square from (a0, b0) to (a1, b1) in the face's own coordinates, on screen
+    auto project = [&](const FaceAxes& axes, float a0, float b0, float a1, float b1, float xs[4], float ys[4]) {
+        const float as[4] = {a0, a1, a1, a0};
+        const float bs[4] = {b0, b0, b1, b1};
+
+        for (int k = 0; k < 4; k++) {
+            float p[3];
+            for (int d = 0; d < 3; d++) {
+                p[d] = 1.5f * axes.n[d] + as[k] * axes.u[d] + bs[k] * axes.v[d];
+            }
+
+            float r[3];
+            rotate(p, r);
+            xs[k] = centerX + r[0] * scale;
+            ys[k] = centerY - r[1] * scale;
+        }
+    };
+
+    for (int face = 0; face < 6; face++) {
+        const FaceAxes& axes = FACE_AXES[face];
+
+        float normal[3];
+        rotate(axes.n, normal);
+
+        //The cube is convex, so the faces pointing at the viewer never overlap
+        if (normal[2] <= 0) continue;
+
+        float xs[4], ys[4];
+        project(axes, -1.5f, -1.5f, 1.5f, 1.5f, xs, ys);
+        image.fillQuad(xs, ys, CUBE_IMAGE_COLORS[6]);
+
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                //Same border as the shader draws
+                float a = j - 1.5f;
+                float b = i - 1.5f;
+
+                project(axes, a + 0.05f, b + 0.05f, a + 0.95f, b + 0.95f, xs, ys);
+                image.fillQuad(xs, ys, CUBE_IMAGE_COLORS[cube.sides[face][i][j]]);
+            }
+        }
+    }
+}
+
+void drawCubeImage(Image& image, const RubiksCube& cube, CubeImageStyle style, int x, int y, int cellWidth, int cellHeight) {
+    if (style == CubeImageStyle::NET) {
+        int squareSize = std::min(cellWidth / 12, cellHeight / 9);
+        drawNet(image, cube, x + (cellWidth - squareSize * 12) / 2, y + (cellHeight - squareSize * 9) / 2, squareSize);
+    } else {
+        int size = std::min(cellWidth, cellHeight);
+        drawCubeView(image, cube, x + (cellWidth - size) / 2, y + (cellHeight - size) / 2, size);
+    }
+}
+
+void writeCubeImages(const std::vector<RubiksCube>& cubes, CubeImageStyle style, int cellWidth, int cellHeight, const std::string& pathPrefix, int numThreads) {
+    runWorkStealing(numThreads, (int) cubes.size(), [&](int i) {
+        Image image(cellWidth, cellHeight, BACKGROUND);
+        drawCubeImage(image, cubes[i], style, 0, 0, cellWidth, cellHeight);
+
+        std::string path = pathPrefix + std::to_string(i) + ".png";
+        if (!image.writePNG(path)) {
+            std::cerr << "Couldn't write " << path << std::endl;
+        }
+    });
+}
+
+void writeCubeAtlases(const std::vector<RubiksCube>& cubes, CubeImageStyle style, int cellWidth, int cellHeight, int columns, int rows, const std::string& pathPrefix, int numThreads) {
+    int perPage = columns * rows;
+    int numPages = ((int) cubes.size() + perPage - 1) / perPage;
+
+    runWorkStealing(numThreads, numPages, [&](int page) {
+        int first = page * perPage;
+        int count = std::min(perPage, (int) cubes.size() - first);
+        //A page that isn't full only gets as many rows (and columns) as it needs
+        int pageColumns = std::min(columns, count);
+        int pageRows = (count + columns - 1) / columns;
+
+        Image image(pageColumns * cellWidth, pageRows * cellHeight, BACKGROUND);
+
+        for (int i = 0; i < count; i++) {
+            drawCubeImage(image, cubes[first + i], style, (i % columns) * cellWidth, (i / columns) * cellHeight, cellWidth, cellHeight);
+        }
+
+        std::string path = pathPrefix + std::to_string(page) + ".png";
+        if (!image.writePNG(path)) {
+            std::cerr << "Couldn't write " << path << std::endl;
+        }
+    });
+}
@@ -0,0 +1,57 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_CUBEIMAGE_H
+#define RUBIK_CUBEIMAGE_H
+
+#include "src/cube/RubiksCube.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Draws cubes into plain RGB images on the CPU, so reports can render thumbnails without a window or an OpenGL
+ * context. Nets look like RubiksCube::saveNetImage, views show the front, right and top faces like the 3D renderer.
+ * Batches are drawn and PNG encoded on several threads, either as one file per cube or packed into atlas pages.
+ */
+
+struct Image {
+    int width = 0;
+    int height = 0;
+    //RGB, row by row
+    std::vector<uint8_t> pixels;
+
+    Image() = default;
+    Image(int width, int height, const uint8_t background[3]);
+
+    void fillRect(int x, int y, int w, int h, const uint8_t color[3]);
+    //Fills the convex quad with corners (xs[i], ys[i]), given in order around it
+    void fillQuad(const float xs[4], const float ys[4], const uint8_t color[3]);
+
+    bool writePNG(const std::string& path) const;
+};
+
+enum class CubeImageStyle {
+    NET,
+    VIEW
+};
+
+//Red Orange Blue Green Yellow White, then the border
+extern const uint8_t CUBE_IMAGE_COLORS[7][3];
+
+//A net of squareSize pixels per sticker, 12 by 9 stickers with the top left corner at (x, y)
+void drawNet(Image& image, const RubiksCube& cube, int x, int y, int squareSize);
+//The front, right and top faces seen from above and to the right, filling a size by size square at (x, y)
+void drawCubeView(Image& image, const RubiksCube& cube, int x, int y, int size);
+
+//Draws cube centered in the cell at (x, y)
+void drawCubeImage(Image& image, const RubiksCube& cube, CubeImageStyle style, int x, int y, int cellWidth, int cellHeight);
+
+//Writes <pathPrefix><index>.png for every cube, numThreads = 0 uses every core
+void writeCubeImages(const std::vector<RubiksCube>& cubes, CubeImageStyle style, int cellWidth, int cellHeight, const std::string& pathPrefix, int numThreads = 0);
+//Packs the cubes into pages of columns by rows cells, written to <pathPrefix><page>.png
+void writeCubeAtlases(const std::vector<RubiksCube>& cubes, CubeImageStyle style, int cellWidth, int cellHeight, int columns, int rows, const std::string& pathPrefix, int numThreads = 0);
+
+#endif //RUBIK_CUBEIMAGE_H
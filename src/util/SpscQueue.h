@@ -0,0 +1,57 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_SPSCQUEUE_H
+#define RUBIK_SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+/*
+ * Bounded lock-free queue between one producer thread and one consumer thread. The producer only writes tail and the
+ * consumer only writes head, so neither ever waits on the other. Has the same empty/front/pop as std::queue, so a
+ * consumer written against one works with the other.
+ */
+template<typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    //Producer only, false if the queue is full
+    bool push(const T& value) {
+        size_t currTail = tail.load(std::memory_order_relaxed);
+
+        if (currTail - head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+
+        items[currTail & (Capacity - 1)] = value;
+        tail.store(currTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    //Consumer only
+    bool empty() const {
+        return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire);
+    }
+
+    //Consumer only, the queue mustn't be empty
+    T& front() {
+        return items[head.load(std::memory_order_relaxed) & (Capacity - 1)];
+    }
+
+    //Consumer only, the queue mustn't be empty
+    void pop() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    T items[Capacity];
+
+    //On their own cache lines so the two threads don't keep taking the line from each other
+    alignas(64) std::atomic<size_t> head = 0;
+    alignas(64) std::atomic<size_t> tail = 0;
+};
+
+#endif //RUBIK_SPSCQUEUE_H
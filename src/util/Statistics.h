@@ -0,0 +1,21 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_STATISTICS_H
+#define RUBIK_STATISTICS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+//Nearest rank percentile of a sorted list, -1 if it's empty
+inline double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return -1;
+
+    size_t rank = (size_t) std::ceil(p * sorted.size());
+    return sorted[std::clamp(rank, (size_t) 1, sorted.size()) - 1];
+}
+
+#endif //RUBIK_STATISTICS_H
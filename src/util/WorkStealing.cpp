@@ -0,0 +1,84 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#include "WorkStealing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+void runWorkStealing(int numThreads, int numTasks, const std::function<void(int)>& task) {
+    runWorkStealing(numThreads, numTasks, [&](int taskIdx, int) {
+        task(taskIdx);
+    });
+}
+
+void runWorkStealing(int numThreads, int numTasks, const std::function<void(int task, int thread)>& task) {
+    struct alignas(64) TaskRange {
+        std::mutex mutex;
+        //Only changed while holding mutex, atomic so steal can look at them without it
+        std::atomic<int> begin;
+        std::atomic<int> end;
+    };
+
+    if (numThreads <= 0) {
+        numThreads = (int) std::max(1u, std::thread::hardware_concurrency());
+    }
+    numThreads = std::max(1, std::min(numThreads, numTasks));
+    std::vector<TaskRange> ranges(numThreads);
+
+    for (int i = 0; i < numThreads; i++) {
+        ranges[i].begin = (int) ((int64_t) numTasks * i / numThreads);
+        ranges[i].end = (int) ((int64_t) numTasks * (i + 1) / numThreads);
+    }
+
+    auto takeOwn = [&](int thread, int& taskIdx) {
+        std::lock_guard<std::mutex> lock(ranges[thread].mutex);
+        if (ranges[thread].begin >= ranges[thread].end) return false;
+
+        taskIdx = ranges[thread].begin++;
+        return true;
+    };
+
+    auto steal = [&](int& taskIdx) {
+        while (true) {
+            //A stale size only makes us pick a slightly worse victim
+            int victim = -1;
+            int mostLeft = 0;
+
+            for (int i = 0; i < numThreads; i++) {
+                int left = ranges[i].end - ranges[i].begin;
+                if (left > mostLeft) {
+                    mostLeft = left;
+                    victim = i;
+                }
+            }
+
+            if (victim == -1) return false;
+
+            std::lock_guard<std::mutex> lock(ranges[victim].mutex);
+            if (ranges[victim].begin < ranges[victim].end) {
+                taskIdx = --ranges[victim].end;
+                return true;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; i++) {
+        threads.emplace_back([&, i]() {
+            int taskIdx;
+            while (takeOwn(i, taskIdx) || steal(taskIdx)) {
+                task(taskIdx, i);
+            }
+        });
+    }
+
+    for (std::thread& thread: threads) {
+        thread.join();
+    }
+}
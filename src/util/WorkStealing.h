@@ -0,0 +1,22 @@
+//
+// Created by Anatol on 19/10/2026.
+//
+
+#ifndef RUBIK_WORKSTEALING_H
+#define RUBIK_WORKSTEALING_H
+
+#include <functional>
+
+/*
+ * Runs task(i) for every i in [0, numTasks) on numThreads threads and waits for all of them. numThreads <= 0 uses every
+ * core.
+ *
+ * Every thread starts on its own contiguous range of tasks and works through it from the front. A thread that runs out
+ * steals from the back of whichever range has the most left, so search subtrees of very different sizes still end up
+ * spread evenly.
+ */
+void runWorkStealing(int numThreads, int numTasks, const std::function<void(int)>& task);
+//Also passes which thread runs the task, from 0 to the number of threads used
+void runWorkStealing(int numThreads, int numTasks, const std::function<void(int task, int thread)>& task);
+
+#endif //RUBIK_WORKSTEALING_H